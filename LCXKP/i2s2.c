@@ -22,6 +22,10 @@
 
 /* USER CODE BEGIN 0 */
 #if SPI2_OR_I2S2==MODE_I2S
+
+/* SPI2_TX 固定映射到 DMA1 Stream4 Channel0, I2S2_EXT_RX 为 DMA1 Stream3 Channel3 (RM0090 表 42) */
+DMA_HandleTypeDef hdma_spi2_tx;
+DMA_HandleTypeDef hdma_i2s2_ext_rx;
 /* USER CODE END 0 */
 
 I2S_HandleTypeDef hi2s2;
@@ -110,7 +114,48 @@ void HAL_I2S_MspInit(I2S_HandleTypeDef* i2sHandle)
     HAL_GPIO_Init(GPIOB, &GPIO_InitStruct);
 
   /* USER CODE BEGIN SPI2_MspInit 1 */
+    /* I2S2 DMA Init: SPI2_TX 循环模式, 由 i2s2_audio.c 做半满/全满双缓冲 */
+    __HAL_RCC_DMA1_CLK_ENABLE();
+
+    hdma_spi2_tx.Instance = DMA1_Stream4;
+    hdma_spi2_tx.Init.Channel = DMA_CHANNEL_0;
+    hdma_spi2_tx.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hdma_spi2_tx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_spi2_tx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_spi2_tx.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_spi2_tx.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_spi2_tx.Init.Mode = DMA_CIRCULAR;
+    hdma_spi2_tx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_spi2_tx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_spi2_tx) != HAL_OK)
+    {
+      Error_Handler();
+    }
 
+    __HAL_LINKDMA(i2sHandle,hdmatx,hdma_spi2_tx);
+
+    /* 全双工接收 (PC2 I2S2_ext_SD): HAL 在全双工模式下用 hdmarx 搬运 I2S2ext->DR */
+    hdma_i2s2_ext_rx.Instance = DMA1_Stream3;
+    hdma_i2s2_ext_rx.Init.Channel = DMA_CHANNEL_3;
+    hdma_i2s2_ext_rx.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    hdma_i2s2_ext_rx.Init.PeriphInc = DMA_PINC_DISABLE;
+    hdma_i2s2_ext_rx.Init.MemInc = DMA_MINC_ENABLE;
+    hdma_i2s2_ext_rx.Init.PeriphDataAlignment = DMA_PDATAALIGN_HALFWORD;
+    hdma_i2s2_ext_rx.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+    hdma_i2s2_ext_rx.Init.Mode = DMA_CIRCULAR;
+    hdma_i2s2_ext_rx.Init.Priority = DMA_PRIORITY_HIGH;
+    hdma_i2s2_ext_rx.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    if (HAL_DMA_Init(&hdma_i2s2_ext_rx) != HAL_OK)
+    {
+      Error_Handler();
+    }
+
+    __HAL_LINKDMA(i2sHandle,hdmarx,hdma_i2s2_ext_rx);
+
+    HAL_NVIC_SetPriority(DMA1_Stream4_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream4_IRQn);
+    HAL_NVIC_SetPriority(DMA1_Stream3_IRQn, 1, 0);
+    HAL_NVIC_EnableIRQ(DMA1_Stream3_IRQn);
   /* USER CODE END SPI2_MspInit 1 */
   }
 }
@@ -137,11 +182,32 @@ void HAL_I2S_MspDeInit(I2S_HandleTypeDef* i2sHandle)
     HAL_GPIO_DeInit(GPIOB, GPIO_PIN_12|GPIO_PIN_13);
 
   /* USER CODE BEGIN SPI2_MspDeInit 1 */
-
+    HAL_DMA_DeInit(i2sHandle->hdmatx);
+    HAL_DMA_DeInit(i2sHandle->hdmarx);
+    HAL_NVIC_DisableIRQ(DMA1_Stream4_IRQn);
+    HAL_NVIC_DisableIRQ(DMA1_Stream3_IRQn);
   /* USER CODE END SPI2_MspDeInit 1 */
   }
 }
 
 /* USER CODE BEGIN 1 */
+
+/**
+  * @brief DMA1 Stream4 中断 (SPI2_TX / I2S2 发送)
+  * @note  如果 CubeMX 已在 stm32f4xx_it.c 中生成了同名函数, 删除其中一个即可
+  */
+void DMA1_Stream4_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_spi2_tx);
+}
+
+/**
+  * @brief DMA1 Stream3 中断 (I2S2_EXT 全双工接收)
+  */
+void DMA1_Stream3_IRQHandler(void)
+{
+  HAL_DMA_IRQHandler(&hdma_i2s2_ext_rx);
+}
+
 #endif
 /* USER CODE END 1 */
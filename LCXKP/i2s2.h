@@ -35,6 +35,8 @@ extern "C" {
 extern I2S_HandleTypeDef hi2s2;
 
 /* USER CODE BEGIN Private defines */
+extern DMA_HandleTypeDef hdma_spi2_tx;
+extern DMA_HandleTypeDef hdma_i2s2_ext_rx;
 
 /* USER CODE END Private defines */
 
@@ -0,0 +1,408 @@
+#include "i2s2_audio.h"
+#include <string.h>
+
+#if SPI2_OR_I2S2==MODE_I2S
+
+#if (I2S2_AUDIO_FIFO_LEN & (I2S2_AUDIO_FIFO_LEN - 1)) != 0
+#error "I2S2_AUDIO_FIFO_LEN must be a power of 2"
+#endif
+
+// ================= 内部变量 =================
+
+/* DMA 双缓冲: [0, N) 为前半区, [N, 2N) 为后半区, N = s_block_len */
+static int16_t s_tx_buf[2 * I2S2_AUDIO_BLOCK_LEN];
+static int16_t s_rx_buf[2 * I2S2_AUDIO_BLOCK_LEN];
+static uint16_t s_block_len = I2S2_AUDIO_BLOCK_LEN;
+
+/* 单生产者 (主循环) / 单消费者 (DMA 中断) 的无锁 FIFO, 下标自由递增 */
+static int16_t s_fifo[I2S2_AUDIO_FIFO_LEN];
+static volatile uint32_t s_fifo_wr;
+static volatile uint32_t s_fifo_rd;
+
+static I2S2_Audio_FillCallback s_fill;
+static volatile I2S2_Audio_Stats_t s_stats;
+
+/* 全双工: 处理钩子链 */
+static I2S2_Audio_Hook s_hooks[I2S2_AUDIO_MAX_HOOKS];
+static void *s_hook_ctx[I2S2_AUDIO_MAX_HOOKS];
+static volatile uint8_t s_hook_count;
+
+/* 全双工: 块延迟环, 写入第 wr 块, 输出第 wr - delay 块 */
+static int16_t s_delay_buf[I2S2_AUDIO_MAX_DELAY + 1][I2S2_AUDIO_BLOCK_LEN];
+static uint8_t s_delay_wr;
+static uint8_t s_delay_blocks;
+
+static int16_t s_mix_tmp[I2S2_AUDIO_BLOCK_LEN];
+
+/* 采样率/格式表, 离线穷举 PLLI2SN(50~432) x PLLI2SR(2~7) x I2SDIV(2~255) x ODD 取误差最小者.
+ * 条件: PLLI2S 输入 2MHz, VCO 100~432MHz, MCLK 输出关闭.
+ * Fs = IN * N / R / (ch_bits * 2 * (2 * DIV + ODD)) */
+typedef struct {
+    uint32_t rate;      // 目标采样率 (Hz)
+    uint8_t  ch_bits;   // 每声道位宽: 16 (16bit 数据) 或 32 (24/32bit 数据)
+    uint16_t plli2sn;
+    uint8_t  plli2sr;
+    uint8_t  i2sdiv;
+    uint8_t  odd;
+} I2S2_Audio_ClockCfg_t;
+
+static const I2S2_Audio_ClockCfg_t s_clock_table[] = {
+    {   8000u, 16,  64, 2, 125, 0 }, // 8000.000 Hz, +0.0 ppm
+    {  16000u, 16,  64, 2,  62, 1 }, // 16000.000 Hz, +0.0 ppm
+    {  22050u, 16, 145, 3,  68, 1 }, // 22049.878 Hz, -5.5 ppm
+    {  32000u, 16,  64, 5,  12, 1 }, // 32000.000 Hz, +0.0 ppm
+    {  44100u, 16, 151, 2,  53, 1 }, // 44100.467 Hz, +10.6 ppm
+    {  48000u, 16,  96, 5,  12, 1 }, // 48000.000 Hz, +0.0 ppm
+    {  96000u, 16, 192, 5,  12, 1 }, // 96000.000 Hz, +0.0 ppm
+    {   8000u, 32,  64, 2,  62, 1 }, // 8000.000 Hz, +0.0 ppm
+    {  16000u, 32,  64, 5,  12, 1 }, // 16000.000 Hz, +0.0 ppm
+    {  22050u, 32, 151, 2,  53, 1 }, // 22050.234 Hz, +10.6 ppm
+    {  32000u, 32, 128, 5,  12, 1 }, // 32000.000 Hz, +0.0 ppm
+    {  44100u, 32, 127, 2,  22, 1 }, // 44097.222 Hz, -63.0 ppm
+    {  48000u, 32, 192, 5,  12, 1 }, // 48000.000 Hz, +0.0 ppm
+    {  96000u, 32, 212, 3,  11, 1 }, // 96014.493 Hz, +151.0 ppm
+};
+
+/* 当前时钟配置, NULL 表示仍是 MX_I2S2_Init 的默认值 */
+static const I2S2_Audio_ClockCfg_t *s_clock;
+static I2S2_Audio_Format_t s_format = I2S2_AUDIO_16BIT;
+
+// ================= 内部静态辅助函数 =================
+
+/**
+ * @brief 从 FIFO 读出数据 (中断上下文)
+ */
+static uint32_t I2S2_Audio_FifoRead(int16_t *buf, uint32_t len) {
+    uint32_t avail = s_fifo_wr - s_fifo_rd;
+    if (len > avail) len = avail;
+
+    uint32_t rd = s_fifo_rd & (I2S2_AUDIO_FIFO_LEN - 1);
+    uint32_t first = I2S2_AUDIO_FIFO_LEN - rd;
+    if (first > len) first = len;
+
+    memcpy(buf, &s_fifo[rd], first * sizeof(int16_t));
+    memcpy(buf + first, &s_fifo[0], (len - first) * sizeof(int16_t));
+
+    s_fifo_rd += len;
+    return len;
+}
+
+/**
+ * @brief 半字数 -> HAL DMA 接口的 Size 参数
+ * @note  24/32bit 格式下 HAL 以 "采样" 为单位并在内部乘 2, 所以要先除 2
+ */
+static uint16_t I2S2_Audio_DmaSize(uint32_t halfwords) {
+    return (uint16_t)((s_format == I2S2_AUDIO_16BIT) ? halfwords : halfwords / 2);
+}
+
+/**
+ * @brief 发送 DMA 距离开始播放指定半区还差多少半字
+ * @note  NDTR 为剩余半字数 (从 2N 递减). 正常情况下结果在 (0, N] 内;
+ *        大于 N 说明 DMA 已经在读该半区, 本次填充迟到了
+ */
+static uint32_t I2S2_Audio_TxDistance(uint8_t half) {
+    uint32_t n = s_block_len;
+    uint32_t ndtr = __HAL_DMA_GET_COUNTER(hi2s2.hdmatx);
+    if (half == 0) return ndtr;
+    return (ndtr > n) ? (ndtr - n) : (ndtr + n);
+}
+
+/**
+ * @brief 填充一个半缓冲并检查是否迟到
+ * @param half 0: 前半区 (HT 中断), 1: 后半区 (TC 中断)
+ */
+static void I2S2_Audio_FillHalf(uint8_t half) {
+    uint32_t n = s_block_len;
+    int16_t *dst = &s_tx_buf[half * n];
+    uint32_t got;
+
+    s_stats.irq_count++;
+
+    if (s_fill != NULL) {
+        got = s_fill(dst, n);
+        if (got > n) got = n;
+    } else {
+        got = I2S2_Audio_FifoRead(dst, n);
+    }
+
+    // 数据不够: 剩余部分补静音, 避免重复播放旧数据
+    if (got < n) {
+        memset(&dst[got], 0, (n - got) * sizeof(int16_t));
+        s_stats.underruns++;
+        s_stats.underrun_samples += n - got;
+    }
+    s_stats.blocks++;
+
+    if (I2S2_Audio_TxDistance(half) > n) s_stats.late++;
+}
+
+/**
+ * @brief 全双工: 处理刚采集完的半区, 结果写入对应的发送半区
+ * @param half 0: 前半区 (HT 中断), 1: 后半区 (TC 中断)
+ */
+static void I2S2_Audio_ProcessHalf(uint8_t half) {
+    uint32_t n = s_block_len;
+    int16_t *rx = &s_rx_buf[half * n];
+    int16_t *tx = &s_tx_buf[half * n];
+    uint32_t start = DWT->CYCCNT;
+
+    s_stats.irq_count++;
+
+    // 采集数据进入延迟环, 钩子在环内原地处理.
+    // TX 与 RX 同时钟同位置, 此刻 tx 半区里的就是采集这一块时正在播放的数据
+    int16_t *blk = s_delay_buf[s_delay_wr];
+    memcpy(blk, rx, n * sizeof(int16_t));
+    for (uint8_t i = 0; i < s_hook_count; i++) {
+        s_hooks[i](blk, tx, n, s_hook_ctx[i]);
+    }
+
+    uint8_t rd = (s_delay_wr + (I2S2_AUDIO_MAX_DELAY + 1) - s_delay_blocks) % (I2S2_AUDIO_MAX_DELAY + 1);
+    memcpy(tx, s_delay_buf[rd], n * sizeof(int16_t));
+    s_delay_wr = (s_delay_wr + 1) % (I2S2_AUDIO_MAX_DELAY + 1);
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    s_stats.proc_cycles = cycles;
+    if (cycles > s_stats.proc_cycles_max) s_stats.proc_cycles_max = cycles;
+
+    // 块内任一采样点的延迟都相同: 采集窗口 + 发送端轮到该半区前的距离 + 额外延迟块
+    uint32_t dist = I2S2_Audio_TxDistance(half);
+    uint32_t latency = n + dist + (uint32_t)s_delay_blocks * n;
+    s_stats.latency_samples = latency;
+    if (latency > s_stats.latency_samples_max) s_stats.latency_samples_max = latency;
+
+    s_stats.blocks++;
+    if (dist > n) s_stats.late++;
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 启动循环 DMA 播放
+ */
+HAL_StatusTypeDef I2S2_Audio_Start(I2S2_Audio_FillCallback fill) {
+    s_fill = fill;
+    s_block_len = I2S2_AUDIO_BLOCK_LEN;
+
+    // 预先填满两个半区, 启动时不会先播一段静音
+    I2S2_Audio_FillHalf(0);
+    I2S2_Audio_FillHalf(1);
+    I2S2_Audio_ResetStats();
+
+    return HAL_I2S_Transmit_DMA(&hi2s2, (uint16_t *)s_tx_buf, I2S2_Audio_DmaSize(2 * I2S2_AUDIO_BLOCK_LEN));
+}
+
+/**
+ * @brief 启动全双工采集+播放
+ */
+HAL_StatusTypeDef I2S2_Audio_StartDuplex(uint16_t block_len, uint8_t delay_blocks) {
+    // 块长必须是整数个立体声帧: 16bit 帧 = 2 半字, 24/32bit 帧 = 4 半字
+    uint16_t frame = (s_format == I2S2_AUDIO_16BIT) ? 2 : 4;
+    if (block_len == 0 || block_len > I2S2_AUDIO_BLOCK_LEN || (block_len % frame) != 0) return HAL_ERROR;
+    if (delay_blocks > I2S2_AUDIO_MAX_DELAY) return HAL_ERROR;
+
+    s_block_len = block_len;
+    s_delay_blocks = delay_blocks;
+    s_delay_wr = 0;
+    memset(s_tx_buf, 0, sizeof(s_tx_buf));
+    memset(s_delay_buf, 0, sizeof(s_delay_buf));
+
+    // 使能 DWT 周期计数器, 用于测量钩子链耗时
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    I2S2_Audio_ResetStats();
+
+    return HAL_I2SEx_TransmitReceive_DMA(&hi2s2, (uint16_t *)s_tx_buf, (uint16_t *)s_rx_buf,
+                                         I2S2_Audio_DmaSize(2 * block_len));
+}
+
+/**
+ * @brief 注册全双工处理钩子
+ */
+HAL_StatusTypeDef I2S2_Audio_AddHook(I2S2_Audio_Hook hook, void *ctx) {
+    if (hook == NULL || s_hook_count >= I2S2_AUDIO_MAX_HOOKS) return HAL_ERROR;
+
+    s_hooks[s_hook_count] = hook;
+    s_hook_ctx[s_hook_count] = ctx;
+    __DSB(); // 先写好表项, 再让中断看到新的数量
+    s_hook_count++;
+    return HAL_OK;
+}
+
+void I2S2_Audio_ClearHooks(void) {
+    s_hook_count = 0;
+}
+
+/**
+ * @brief 内置钩子: Q12 增益, 饱和到 16bit
+ */
+void I2S2_Audio_HookGain(int16_t *block, const int16_t *ref, uint32_t len, void *ctx) {
+    int32_t g = ((I2S2_Audio_Gain_t *)ctx)->gain_q12;
+    (void)ref;
+
+    for (uint32_t i = 0; i < len; i++) {
+        int32_t v = ((int32_t)block[i] * g) >> 12;
+        if (v > 32767) v = 32767;
+        else if (v < -32768) v = -32768;
+        block[i] = (int16_t)v;
+    }
+}
+
+/**
+ * @brief 内置钩子: 混入 FIFO 中的远端音频, 没有数据时不混
+ */
+void I2S2_Audio_HookMixFifo(int16_t *block, const int16_t *ref, uint32_t len, void *ctx) {
+    (void)ref;
+    (void)ctx;
+
+    uint32_t got = I2S2_Audio_FifoRead(s_mix_tmp, len);
+    for (uint32_t i = 0; i < got; i++) {
+        int32_t v = (int32_t)block[i] + s_mix_tmp[i];
+        if (v > 32767) v = 32767;
+        else if (v < -32768) v = -32768;
+        block[i] = (int16_t)v;
+    }
+}
+
+/**
+ * @brief 最近一次测得的延迟 (微秒)
+ */
+uint32_t I2S2_Audio_GetLatencyUs(void) {
+    uint32_t frames = s_stats.latency_samples / ((s_format == I2S2_AUDIO_16BIT) ? 2 : 4);
+    float rate = I2S2_Audio_GetActualRate();
+    if (rate <= 0.0f) return 0;
+    return (uint32_t)((float)frames * 1000000.0f / rate);
+}
+
+/**
+ * @brief 运行时切换采样率与数据格式
+ * @note  会停止正在进行的传输, 之后需要重新 Start / StartDuplex
+ */
+HAL_StatusTypeDef I2S2_Audio_SetFormat(uint32_t rate_hz, I2S2_Audio_Format_t format) {
+    static const uint32_t hal_format[] = {
+        I2S_DATAFORMAT_16B, I2S_DATAFORMAT_24B, I2S_DATAFORMAT_32B
+    };
+    uint8_t ch_bits = (format == I2S2_AUDIO_16BIT) ? 16 : 32;
+    const I2S2_Audio_ClockCfg_t *cfg = NULL;
+
+    if ((uint32_t)format > I2S2_AUDIO_32BIT) return HAL_ERROR;
+
+    for (uint32_t i = 0; i < sizeof(s_clock_table) / sizeof(s_clock_table[0]); i++) {
+        if (s_clock_table[i].rate == rate_hz && s_clock_table[i].ch_bits == ch_bits) {
+            cfg = &s_clock_table[i];
+            break;
+        }
+    }
+    if (cfg == NULL) return HAL_ERROR; // 表中没有的采样率
+
+    HAL_I2S_DMAStop(&hi2s2);
+
+    // 1. 重新初始化 I2S (MspInit 会先按 CubeMX 默认值配置 PLLI2S)
+    if (HAL_I2S_DeInit(&hi2s2) != HAL_OK) return HAL_ERROR;
+    hi2s2.Init.AudioFreq = rate_hz;
+    hi2s2.Init.DataFormat = hal_format[format];
+    if (HAL_I2S_Init(&hi2s2) != HAL_OK) return HAL_ERROR;
+
+    // 2. PLLI2S 换成表中的 N/R (I2S 此时尚未使能, 可以安全切换)
+    RCC_PeriphCLKInitTypeDef clk = {0};
+    clk.PeriphClockSelection = RCC_PERIPHCLK_I2S;
+    clk.PLLI2S.PLLI2SN = cfg->plli2sn;
+    clk.PLLI2S.PLLI2SR = cfg->plli2sr;
+    if (HAL_RCCEx_PeriphCLKConfig(&clk) != HAL_OK) return HAL_ERROR;
+
+    // 3. 用表中的分频覆盖 HAL 按 AudioFreq 估算出来的 I2SPR
+    hi2s2.Instance->I2SPR = cfg->i2sdiv | (cfg->odd ? SPI_I2SPR_ODD : 0) |
+                            (hi2s2.Init.MCLKOutput == I2S_MCLKOUTPUT_ENABLE ? SPI_I2SPR_MCKOE : 0);
+
+    s_clock = cfg;
+    s_format = format;
+    return HAL_OK;
+}
+
+/**
+ * @brief 当前实际采样率 (Hz)
+ * @note  未调用过 I2S2_Audio_SetFormat 时按 I2SPR 和 CubeMX 默认 PLLI2S 计算
+ */
+float I2S2_Audio_GetActualRate(void) {
+    uint32_t n = 50, r = 2; // 与 HAL_I2S_MspInit 中的默认值一致
+    uint32_t ch_bits = (s_format == I2S2_AUDIO_16BIT) ? 16 : 32;
+    uint32_t pr = hi2s2.Instance->I2SPR;
+    uint32_t div = pr & 0xFF;
+    uint32_t odd = (pr & SPI_I2SPR_ODD) ? 1 : 0;
+
+    if (s_clock != NULL) {
+        n = s_clock->plli2sn;
+        r = s_clock->plli2sr;
+    }
+    if (div < 2) return 0.0f;
+
+    return (float)I2S2_AUDIO_PLLI2S_IN_HZ * n / r / (ch_bits * 2 * (2 * div + odd));
+}
+
+/**
+ * @brief 停止播放
+ */
+HAL_StatusTypeDef I2S2_Audio_Stop(void) {
+    return HAL_I2S_DMAStop(&hi2s2);
+}
+
+/**
+ * @brief 写入 PCM 数据到 FIFO (主循环上下文)
+ */
+uint32_t I2S2_Audio_Write(const int16_t *pcm, uint32_t len) {
+    uint32_t space = I2S2_Audio_GetFree();
+    if (len > space) len = space;
+
+    uint32_t wr = s_fifo_wr & (I2S2_AUDIO_FIFO_LEN - 1);
+    uint32_t first = I2S2_AUDIO_FIFO_LEN - wr;
+    if (first > len) first = len;
+
+    memcpy(&s_fifo[wr], pcm, first * sizeof(int16_t));
+    memcpy(&s_fifo[0], pcm + first, (len - first) * sizeof(int16_t));
+
+    __DSB(); // 数据写完之后再发布写指针
+    s_fifo_wr += len;
+    return len;
+}
+
+/**
+ * @brief FIFO 剩余空间
+ */
+uint32_t I2S2_Audio_GetFree(void) {
+    return I2S2_AUDIO_FIFO_LEN - (s_fifo_wr - s_fifo_rd);
+}
+
+void I2S2_Audio_GetStats(I2S2_Audio_Stats_t *stats) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *stats = *(I2S2_Audio_Stats_t *)&s_stats;
+    __set_PRIMASK(primask);
+}
+
+void I2S2_Audio_ResetStats(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memset((void *)&s_stats, 0, sizeof(s_stats));
+    __set_PRIMASK(primask);
+}
+
+// ================= HAL 回调 =================
+
+void HAL_I2S_TxHalfCpltCallback(I2S_HandleTypeDef *hi2s) {
+    if (hi2s->Instance == SPI2) I2S2_Audio_FillHalf(0);
+}
+
+void HAL_I2S_TxCpltCallback(I2S_HandleTypeDef *hi2s) {
+    if (hi2s->Instance == SPI2) I2S2_Audio_FillHalf(1);
+}
+
+/* 全双工: HAL 由接收 DMA 的半满/全满驱动这两个回调 */
+void HAL_I2SEx_TxRxHalfCpltCallback(I2S_HandleTypeDef *hi2s) {
+    if (hi2s->Instance == SPI2) I2S2_Audio_ProcessHalf(0);
+}
+
+void HAL_I2SEx_TxRxCpltCallback(I2S_HandleTypeDef *hi2s) {
+    if (hi2s->Instance == SPI2) I2S2_Audio_ProcessHalf(1);
+}
+
+#endif
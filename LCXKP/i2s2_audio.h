@@ -0,0 +1,160 @@
+/**
+ ******************************************************************************
+ * @file        i2s2_audio.h
+ * @version     v1.1
+ * @date        2026-10-18
+ * @author      ztf402
+ * @brief       I2S2 audio stream engine (circular DMA + double buffer)
+ * @copyright   (C) Copyright 2026, ztf402.
+ *              All Rights Reserved.
+ ******************************************************************************
+ * @details
+ * DMA 以循环模式搬运一个双缓冲, 每半个缓冲产生一次中断 (半满 HT / 全满 TC),
+ * 在中断里填充刚播放完的那一半. CPU 每个块只进一次中断, 而不是每个采样点.
+ *
+ * 全双工模式下 I2S2 (PC3) 发送, I2S2_ext (PC2) 接收, 两路共用同一个 CK/WS,
+ * 因此 TX/RX 两个 DMA 天然逐采样同步. 每采到一个块, 依次调用处理钩子
+ * (增益/混音/回声消除等), 结果经过可配置的块延迟后写入发送半区.
+ *
+ * 采集到输出的延迟 = 块长 (采集窗口) + 块长 (等待另一半区播完) + 延迟块数 * 块长
+ *
+ * @par Function List
+ * - I2S2_Audio_Start / I2S2_Audio_Stop
+ * - I2S2_Audio_Write   : 主循环向内部 FIFO 推送 PCM 数据
+ * - I2S2_Audio_StartDuplex / I2S2_Audio_AddHook / I2S2_Audio_ClearHooks
+ * - I2S2_Audio_GetStats: 读取欠载/迟到计数与延迟测量
+ * - I2S2_Audio_SetFormat / I2S2_Audio_GetActualRate: 运行时切换采样率和位宽
+ *
+ * @par Change Log
+ * | Version | Date | Author | Description |
+ * |----------|------|---------|-------------|
+ * | v1.0 | 2026-10-18 | ztf402 | Playback engine |
+ * | v1.1 | 2026-10-18 | ztf402 | Full-duplex capture + playback pipeline |
+ * | v1.2 | 2026-10-18 | ztf402 | Runtime sample rate / format with PLLI2S table |
+ ******************************************************************************
+ */
+
+#ifndef __I2S2_AUDIO_H__
+#define __I2S2_AUDIO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "i2s2.h"
+
+#if SPI2_OR_I2S2==MODE_I2S
+
+// ================= 配置区域 =================
+
+/* 半缓冲长度上限 (单位: 16bit 半字, 立体声 L/R 各占一个) */
+#define I2S2_AUDIO_BLOCK_LEN    256
+
+/* 软件 FIFO 长度 (必须是 2 的幂), 给主循环留出的缓冲余量 */
+#define I2S2_AUDIO_FIFO_LEN     2048
+
+/* 全双工处理钩子的最大数量 */
+#define I2S2_AUDIO_MAX_HOOKS    4
+
+/* 全双工额外延迟的最大块数 */
+#define I2S2_AUDIO_MAX_DELAY    4
+
+/* PLLI2S 输入频率 (HSE / PLLM). CubeMX 默认的 PLLI2SN = 50 只有在 2MHz 输入下
+ * VCO 才能落在 100MHz 下限, 采样率表按此生成, 改了时钟树需要重新生成表 */
+#define I2S2_AUDIO_PLLI2S_IN_HZ 2000000u
+
+// ================= 数据结构 =================
+
+/* 数据格式. 24/32bit 下每个采样占 2 个半字 (高半字在前), 声道帧长 32bit */
+typedef enum {
+    I2S2_AUDIO_16BIT = 0,
+    I2S2_AUDIO_24BIT,
+    I2S2_AUDIO_32BIT
+} I2S2_Audio_Format_t;
+
+/**
+ * @brief 填充回调 (在 DMA 中断中调用)
+ * @param buf 需要填充的半缓冲
+ * @param len 半缓冲长度 (半字)
+ * @return 实际写入的半字数, 小于 len 视为欠载, 剩余部分自动补 0
+ */
+typedef uint32_t (*I2S2_Audio_FillCallback)(int16_t *buf, uint32_t len);
+
+/**
+ * @brief 全双工块处理钩子 (在 DMA 中断中调用), 按 16bit 样本处理, 仅 16bit 格式下有意义
+ * @param block 原地处理的数据块, 进入第一个钩子时为采集到的数据
+ * @param ref   与该块同时刻播放出去的数据 (回声消除的远端参考)
+ * @param len   块长度 (半字)
+ * @param ctx   注册时传入的参数
+ */
+typedef void (*I2S2_Audio_Hook)(int16_t *block, const int16_t *ref, uint32_t len, void *ctx);
+
+/* 增益钩子参数: Q12 定点, 4096 = 1.0 */
+typedef struct {
+    int16_t gain_q12;
+} I2S2_Audio_Gain_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t irq_count;    // DMA 半满/全满中断次数
+    uint32_t blocks;       // 已填充的半缓冲数
+    uint32_t underruns;    // 数据源不足, 补静音的次数
+    uint32_t underrun_samples; // 累计补静音的半字数
+    uint32_t late;         // 填充完成时 DMA 已读到该半区 (已产生毛刺)
+
+    // 以下仅全双工模式有效
+    uint32_t latency_samples;     // 最近一次测得的采集->输出延迟 (半字)
+    uint32_t latency_samples_max; // 最大延迟 (半字)
+    uint32_t proc_cycles;         // 最近一次钩子链耗时 (CPU 周期)
+    uint32_t proc_cycles_max;     // 钩子链最大耗时 (CPU 周期)
+} I2S2_Audio_Stats_t;
+
+// ================= 函数声明 =================
+
+/* 启动播放. fill 为 NULL 时从内部 FIFO 取数据 (配合 I2S2_Audio_Write) */
+HAL_StatusTypeDef I2S2_Audio_Start(I2S2_Audio_FillCallback fill);
+HAL_StatusTypeDef I2S2_Audio_Stop(void);
+
+/* 向 FIFO 写入 PCM 数据, 返回实际写入的半字数 (FIFO 满则少写) */
+uint32_t I2S2_Audio_Write(const int16_t *pcm, uint32_t len);
+/* FIFO 剩余空间 (半字) */
+uint32_t I2S2_Audio_GetFree(void);
+
+/**
+ * @brief 启动全双工采集+播放
+ * @param block_len    块长度 (半字, 偶数, <= I2S2_AUDIO_BLOCK_LEN), 决定基础延迟
+ * @param delay_blocks 额外延迟块数 (<= I2S2_AUDIO_MAX_DELAY)
+ */
+HAL_StatusTypeDef I2S2_Audio_StartDuplex(uint16_t block_len, uint8_t delay_blocks);
+
+/* 注册处理钩子, 按注册顺序执行. 运行中也可以调用 */
+HAL_StatusTypeDef I2S2_Audio_AddHook(I2S2_Audio_Hook hook, void *ctx);
+void I2S2_Audio_ClearHooks(void);
+
+/* 内置钩子: 增益 (ctx 指向 I2S2_Audio_Gain_t) */
+void I2S2_Audio_HookGain(int16_t *block, const int16_t *ref, uint32_t len, void *ctx);
+/* 内置钩子: 把 FIFO 中的数据 (I2S2_Audio_Write 写入的远端音频) 混入输出, ctx 不使用 */
+void I2S2_Audio_HookMixFifo(int16_t *block, const int16_t *ref, uint32_t len, void *ctx);
+
+/* 最近一次测得的采集->输出延迟 (微秒) */
+uint32_t I2S2_Audio_GetLatencyUs(void);
+
+/**
+ * @brief 切换采样率与格式 (停止当前传输)
+ * @param rate_hz 8000/16000/22050/32000/44100/48000/96000
+ * @return HAL_ERROR: 采样率不在表中
+ */
+HAL_StatusTypeDef I2S2_Audio_SetFormat(uint32_t rate_hz, I2S2_Audio_Format_t format);
+/* 实际采样率 (由 PLLI2S 与 I2SPR 反算) */
+float I2S2_Audio_GetActualRate(void);
+
+void I2S2_Audio_GetStats(I2S2_Audio_Stats_t *stats);
+void I2S2_Audio_ResetStats(void);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __I2S2_AUDIO_H__ */
@@ -0,0 +1,339 @@
+#include "ahrs.h"
+#include <math.h>
+#include <string.h> // for memset
+
+#define AHRS_DEG2RAD 0.0174532925f
+#define AHRS_RAD2DEG 57.2957795f
+
+// Q15 角速度参考满量程 (与 ICM_Q15Data_t 一致)
+#define AHRS_Q15_GYRO_DPS  (2000.0f / 32768.0f)
+
+// ================= 内部静态辅助函数 =================
+
+/**
+ * @brief 平方根倒数
+ * @note  快速版本: 改进魔数 + 一次带修正系数的牛顿迭代, 约 6 条 FPU/整数指令,
+ *        而 1.0f/sqrtf 在 M4F 上是 VSQRT + VDIV 各 14 周期
+ */
+static inline float AHRS_InvSqrt(float x) {
+#if AHRS_USE_FAST_INVSQRT
+    union { float f; uint32_t i; } conv;
+    conv.f = x;
+    conv.i = 0x5F1F1412u - (conv.i >> 1);
+    conv.f *= 1.69000231f - 0.714158168f * x * conv.f * conv.f;
+    return conv.f;
+#else
+    return 1.0f / sqrtf(x);
+#endif
+}
+
+static inline uint32_t AHRS_CycleStart(void) {
+#if AHRS_BENCHMARK
+    return DWT->CYCCNT;
+#else
+    return 0;
+#endif
+}
+
+// 记录一次 (或一批 n 次) 更新的耗时
+static void AHRS_CycleEnd(AHRS_t *ahrs, uint32_t start, uint16_t n) {
+#if AHRS_BENCHMARK
+    uint32_t cycles = DWT->CYCCNT - start;
+    uint32_t per = cycles / n;
+
+    ahrs->stats.cycles_last = per;
+    if (per > ahrs->stats.cycles_max) ahrs->stats.cycles_max = per;
+    ahrs->stats.cycles_total += cycles;
+    if (ahrs->cycle_budget != 0 && per > ahrs->cycle_budget) ahrs->stats.over_budget++;
+#else
+    (void)start;
+#endif
+    ahrs->stats.updates += n;
+}
+
+/**
+ * @brief Madgwick IMU 更新, 角速度单位 rad/s
+ * @note  0.5 因子并入 dt: q += (w ⊗ q) * dt/2 - s * beta * dt
+ */
+static void AHRS_MadgwickStep(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay, float az) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float half_dt = 0.5f * ahrs->dt;
+
+    // 陀螺仪积分项 (未乘 0.5)
+    float d0 = -q1 * gx - q2 * gy - q3 * gz;
+    float d1 =  q0 * gx + q2 * gz - q3 * gy;
+    float d2 =  q0 * gy - q1 * gz + q3 * gx;
+    float d3 =  q0 * gz + q1 * gy - q2 * gx;
+
+    q0 += d0 * half_dt;
+    q1 += d1 * half_dt;
+    q2 += d2 * half_dt;
+    q3 += d3 * half_dt;
+
+    float an = ax * ax + ay * ay + az * az;
+    if (an > 0.0f) {
+        float recip = AHRS_InvSqrt(an);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        float p0 = ahrs->q[0], p1 = ahrs->q[1], p2 = ahrs->q[2], p3 = ahrs->q[3];
+        float _2p0 = 2.0f * p0, _2p1 = 2.0f * p1, _2p2 = 2.0f * p2, _2p3 = 2.0f * p3;
+        float _4p0 = 4.0f * p0, _4p1 = 4.0f * p1, _4p2 = 4.0f * p2;
+        float _8p1 = 8.0f * p1, _8p2 = 8.0f * p2;
+        float p0p0 = p0 * p0, p1p1 = p1 * p1, p2p2 = p2 * p2, p3p3 = p3 * p3;
+
+        // 梯度 (目标函数: 重力方向误差)
+        float s0 = _4p0 * p2p2 + _2p2 * ax + _4p0 * p1p1 - _2p1 * ay;
+        float s1 = _4p1 * p3p3 - _2p3 * ax + 4.0f * p0p0 * p1 - _2p0 * ay - _4p1 + _8p1 * p1p1 + _8p1 * p2p2 + _4p1 * az;
+        float s2 = 4.0f * p0p0 * p2 + _2p0 * ax + _4p2 * p3p3 - _2p3 * ay - _4p2 + _8p2 * p1p1 + _8p2 * p2p2 + _4p2 * az;
+        float s3 = 4.0f * p1p1 * p3 - _2p1 * ax + 4.0f * p2p2 * p3 - _2p2 * ay;
+
+        float sn = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+        if (sn > 0.0f) {
+            float k = AHRS_InvSqrt(sn) * ahrs->beta_dt;
+            q0 -= s0 * k;
+            q1 -= s1 * k;
+            q2 -= s2 * k;
+            q3 -= s3 * k;
+        }
+    }
+
+    float recip = AHRS_InvSqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    ahrs->q[0] = q0 * recip;
+    ahrs->q[1] = q1 * recip;
+    ahrs->q[2] = q2 * recip;
+    ahrs->q[3] = q3 * recip;
+}
+
+/**
+ * @brief Mahony IMU 更新, 角速度单位 rad/s
+ */
+static void AHRS_MahonyStep(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay, float az) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+
+    float an = ax * ax + ay * ay + az * az;
+    if (an > 0.0f) {
+        float recip = AHRS_InvSqrt(an);
+        ax *= recip;
+        ay *= recip;
+        az *= recip;
+
+        // 估计的重力方向 (半长)
+        float vx = q1 * q3 - q0 * q2;
+        float vy = q0 * q1 + q2 * q3;
+        float vz = q0 * q0 - 0.5f + q3 * q3;
+
+        // 误差 = 测量方向 x 估计方向
+        float ex = ay * vz - az * vy;
+        float ey = az * vx - ax * vz;
+        float ez = ax * vy - ay * vx;
+
+        if (ahrs->two_ki_dt > 0.0f) {
+            ahrs->integral[0] += ahrs->two_ki_dt * ex;
+            ahrs->integral[1] += ahrs->two_ki_dt * ey;
+            ahrs->integral[2] += ahrs->two_ki_dt * ez;
+            gx += ahrs->integral[0];
+            gy += ahrs->integral[1];
+            gz += ahrs->integral[2];
+        }
+
+        gx += ahrs->two_kp * ex;
+        gy += ahrs->two_kp * ey;
+        gz += ahrs->two_kp * ez;
+    }
+
+    float half_dt = 0.5f * ahrs->dt;
+    gx *= half_dt;
+    gy *= half_dt;
+    gz *= half_dt;
+
+    float n0 = q0 - q1 * gx - q2 * gy - q3 * gz;
+    float n1 = q1 + q0 * gx + q2 * gz - q3 * gy;
+    float n2 = q2 + q0 * gy - q1 * gz + q3 * gx;
+    float n3 = q3 + q0 * gz + q1 * gy - q2 * gx;
+
+    float recip = AHRS_InvSqrt(n0 * n0 + n1 * n1 + n2 * n2 + n3 * n3);
+    ahrs->q[0] = n0 * recip;
+    ahrs->q[1] = n1 * recip;
+    ahrs->q[2] = n2 * recip;
+    ahrs->q[3] = n3 * recip;
+}
+
+static inline void AHRS_Step(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay, float az) {
+    if (ahrs->algo == AHRS_MAHONY) {
+        AHRS_MahonyStep(ahrs, gx, gy, gz, ax, ay, az);
+    } else {
+        AHRS_MadgwickStep(ahrs, gx, gy, gz, ax, ay, az);
+    }
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化
+ */
+void AHRS_Init(AHRS_t *ahrs, AHRS_Algo_t algo, float sample_rate_hz) {
+    memset(ahrs, 0, sizeof(AHRS_t));
+    ahrs->algo = algo;
+    ahrs->beta = AHRS_MADGWICK_BETA;
+    AHRS_SetMahonyGain(ahrs, AHRS_MAHONY_KP, AHRS_MAHONY_KI);
+    AHRS_SetSampleRate(ahrs, sample_rate_hz);
+    AHRS_Reset(ahrs);
+
+#if AHRS_BENCHMARK
+    // 使能 DWT 周期计数器
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+}
+
+/**
+ * @brief 姿态复位为单位四元数, 清零积分
+ */
+void AHRS_Reset(AHRS_t *ahrs) {
+    ahrs->q[0] = 1.0f;
+    ahrs->q[1] = 0.0f;
+    ahrs->q[2] = 0.0f;
+    ahrs->q[3] = 0.0f;
+    ahrs->integral[0] = ahrs->integral[1] = ahrs->integral[2] = 0.0f;
+}
+
+/**
+ * @brief 设置采样率, 同时更新与 dt 相关的预计算量
+ */
+void AHRS_SetSampleRate(AHRS_t *ahrs, float sample_rate_hz) {
+    if (sample_rate_hz <= 0.0f) return;
+    ahrs->dt = 1.0f / sample_rate_hz;
+    ahrs->beta_dt = ahrs->beta * ahrs->dt;
+    ahrs->two_ki_dt = ahrs->two_ki * ahrs->dt;
+}
+
+void AHRS_SetMadgwickGain(AHRS_t *ahrs, float beta) {
+    ahrs->beta = beta;
+    ahrs->beta_dt = beta * ahrs->dt;
+}
+
+void AHRS_SetMahonyGain(AHRS_t *ahrs, float kp, float ki) {
+    ahrs->two_kp = 2.0f * kp;
+    ahrs->two_ki = 2.0f * ki;
+    ahrs->two_ki_dt = ahrs->two_ki * ahrs->dt;
+    if (ki <= 0.0f) {
+        ahrs->integral[0] = ahrs->integral[1] = ahrs->integral[2] = 0.0f;
+    }
+}
+
+void AHRS_SetCycleBudget(AHRS_t *ahrs, uint32_t cycles) {
+    ahrs->cycle_budget = cycles;
+}
+
+/**
+ * @brief 单采样更新
+ */
+void AHRS_Update(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay, float az) {
+    uint32_t start = AHRS_CycleStart();
+
+    AHRS_Step(ahrs, gx * AHRS_DEG2RAD, gy * AHRS_DEG2RAD, gz * AHRS_DEG2RAD, ax, ay, az);
+
+    AHRS_CycleEnd(ahrs, start, 1);
+}
+
+void AHRS_UpdatePhys(AHRS_t *ahrs, const ICM_PhysData_t *data) {
+    AHRS_Update(ahrs, data->gyro_x_dps, data->gyro_y_dps, data->gyro_z_dps,
+                data->accel_x_g, data->accel_y_g, data->accel_z_g);
+}
+
+/**
+ * @brief FIFO 原始数据批量更新
+ * @note  加速度只用于确定方向, 不需要换算到 g; 角速度系数 (LSB -> rad/s) 在循环外算一次
+ */
+void AHRS_UpdateBatch(AHRS_t *ahrs, const ICM42688_t *dev, const ICM_RawData_t *samples, uint16_t n) {
+    if (n == 0) return;
+
+    uint32_t start = AHRS_CycleStart();
+    float gk = dev->gyro_scale * AHRS_DEG2RAD;
+
+    for (uint16_t i = 0; i < n; i++) {
+        const ICM_RawData_t *s = &samples[i];
+        AHRS_Step(ahrs, s->gyro_x_raw * gk, s->gyro_y_raw * gk, s->gyro_z_raw * gk,
+                  (float)s->accel_x_raw, (float)s->accel_y_raw, (float)s->accel_z_raw);
+    }
+
+    AHRS_CycleEnd(ahrs, start, n);
+}
+
+/**
+ * @brief Q15 数据批量更新 (ICM42688_FIFO_ReadQ15 的输出)
+ */
+void AHRS_UpdateBatchQ15(AHRS_t *ahrs, const ICM_Q15Data_t *samples, uint16_t n) {
+    if (n == 0) return;
+
+    uint32_t start = AHRS_CycleStart();
+    const float gk = AHRS_Q15_GYRO_DPS * AHRS_DEG2RAD;
+
+    for (uint16_t i = 0; i < n; i++) {
+        const ICM_Q15Data_t *s = &samples[i];
+        AHRS_Step(ahrs, s->gyro[0] * gk, s->gyro[1] * gk, s->gyro[2] * gk,
+                  (float)s->accel[0], (float)s->accel[1], (float)s->accel[2]);
+    }
+
+    AHRS_CycleEnd(ahrs, start, n);
+}
+
+/**
+ * @brief 读取四元数 (w, x, y, z)
+ */
+void AHRS_GetQuat(const AHRS_t *ahrs, float q[4]) {
+    q[0] = ahrs->q[0];
+    q[1] = ahrs->q[1];
+    q[2] = ahrs->q[2];
+    q[3] = ahrs->q[3];
+}
+
+/**
+ * @brief 四元数转欧拉角 (ZYX 顺序, 单位: 度)
+ */
+void AHRS_GetEuler(const AHRS_t *ahrs, float *roll, float *pitch, float *yaw) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float sp = 2.0f * (q0 * q2 - q1 * q3);
+
+    if (sp > 1.0f) sp = 1.0f;
+    if (sp < -1.0f) sp = -1.0f;
+
+    *roll  = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2) * AHRS_RAD2DEG;
+    *pitch = asinf(sp) * AHRS_RAD2DEG;
+    *yaw   = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3) * AHRS_RAD2DEG;
+}
+
+void AHRS_GetStats(const AHRS_t *ahrs, AHRS_Stats_t *stats) {
+    *stats = ahrs->stats;
+}
+
+void AHRS_ResetStats(AHRS_t *ahrs) {
+    memset(&ahrs->stats, 0, sizeof(AHRS_Stats_t));
+}
+
+/**
+ * @brief 合成数据基准测试: 缓慢旋转 + 带噪声的重力
+ */
+uint32_t AHRS_Benchmark(AHRS_Algo_t algo, uint32_t iterations) {
+    AHRS_t ahrs;
+    uint32_t seed = 12345;
+
+    if (iterations == 0) return 0;
+
+    AHRS_Init(&ahrs, algo, 1000.0f);
+    AHRS_SetMahonyGain(&ahrs, AHRS_MAHONY_KP, 0.1f); // 打开积分, 测最坏路径
+
+    // AHRS_BENCHMARK = 0 时 Init 不使能 DWT, 这里单独使能
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    uint32_t start = DWT->CYCCNT;
+    for (uint32_t i = 0; i < iterations; i++) {
+        seed = seed * 1664525u + 1013904223u; // LCG 噪声 (约 5 周期, 计入结果)
+        float noise = (float)(int32_t)((seed >> 16) & 0xFF) * (1.0f / 2048.0f);
+        AHRS_Step(&ahrs, 0.2f + noise, -0.1f, 0.05f, noise, 0.01f, 1.0f - noise);
+    }
+    return (DWT->CYCCNT - start) / iterations;
+}
@@ -0,0 +1,108 @@
+#ifndef __AHRS_H__
+#define __AHRS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "icm42688.h"
+
+/*
+ * 姿态解算 (6 轴, 无磁力计): Madgwick 梯度下降 / Mahony 互补滤波, 输出四元数.
+ *
+ * 输入可以是单个采样 (ICM_PhysData_t 或 dps/g 分量), 也可以是 FIFO 读出的一批
+ * 原始数据 / Q15 数据. 批量接口在循环外一次算好换算系数, 每个采样只剩乘法.
+ *
+ * 全部使用单精度 (常量带 f 后缀, 不调用 double 库函数), 在 Cortex-M4F 上
+ * 每次更新只走 FPU 指令; 归一化使用快速平方根倒数 (可在配置区关闭).
+ * 每次更新的周期数由 DWT 测量, 可设置周期预算并统计超出次数.
+ */
+
+// ================= 配置区域 =================
+
+/* 快速平方根倒数: 1=魔数 + 一次牛顿迭代 (相对误差 < 0.1%), 0=1.0f/sqrtf (VSQRT + VDIV) */
+#define AHRS_USE_FAST_INVSQRT  1
+
+/* DWT 周期统计: 1=每次更新都计时, 0=关闭 (省去两次寄存器读取) */
+#define AHRS_BENCHMARK         1
+
+/* 默认参数 */
+#define AHRS_MADGWICK_BETA     0.1f
+#define AHRS_MAHONY_KP         1.0f
+#define AHRS_MAHONY_KI         0.0f
+
+// ================= 数据结构 =================
+
+typedef enum {
+    AHRS_MADGWICK = 0,
+    AHRS_MAHONY
+} AHRS_Algo_t;
+
+/* 运行统计 (单位: CPU 周期) */
+typedef struct {
+    uint32_t updates;       // 累计更新次数
+    uint32_t cycles_last;   // 最近一次更新耗时 (批量时为平均每个采样)
+    uint32_t cycles_max;    // cycles_last 的最大值 (批量更新只计时整批, 按平均每个采样计入, 不是批内单个采样的最大值)
+    uint64_t cycles_total;  // 累计耗时
+    uint32_t over_budget;   // 超出周期预算的次数 (批量更新按平均每个采样比较, 一批最多计 1 次)
+} AHRS_Stats_t;
+
+typedef struct {
+    AHRS_Algo_t algo;
+    float       q[4];         // 四元数 w, x, y, z
+    float       dt;           // 采样周期 (s)
+
+    // Madgwick
+    float       beta;
+    float       beta_dt;      // beta * dt, 预先算好
+
+    // Mahony
+    float       two_kp;
+    float       two_ki;
+    float       two_ki_dt;    // 2 * Ki * dt, 预先算好
+    float       integral[3];  // 积分反馈 (rad/s)
+
+    uint32_t     cycle_budget; // 单次更新周期预算, 0 表示不检查
+    AHRS_Stats_t stats;
+} AHRS_t;
+
+// ================= 函数声明 =================
+
+/* 初始化 (四元数复位为单位四元数), sample_rate_hz 为 IMU 输出数据率 */
+void AHRS_Init(AHRS_t *ahrs, AHRS_Algo_t algo, float sample_rate_hz);
+void AHRS_Reset(AHRS_t *ahrs);
+
+/* 参数设置 */
+void AHRS_SetSampleRate(AHRS_t *ahrs, float sample_rate_hz);
+void AHRS_SetMadgwickGain(AHRS_t *ahrs, float beta);
+void AHRS_SetMahonyGain(AHRS_t *ahrs, float kp, float ki);
+void AHRS_SetCycleBudget(AHRS_t *ahrs, uint32_t cycles);
+
+/* 单采样更新: 角速度 dps, 加速度 g (任意比例, 内部会归一化) */
+void AHRS_Update(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay, float az);
+void AHRS_UpdatePhys(AHRS_t *ahrs, const ICM_PhysData_t *data);
+
+/* FIFO 批量更新: 原始数据按 dev 当前量程换算; Q15 数据按 16g / 2000dps 参考量程换算 */
+void AHRS_UpdateBatch(AHRS_t *ahrs, const ICM42688_t *dev, const ICM_RawData_t *samples, uint16_t n);
+void AHRS_UpdateBatchQ15(AHRS_t *ahrs, const ICM_Q15Data_t *samples, uint16_t n);
+
+/* 输出 */
+void AHRS_GetQuat(const AHRS_t *ahrs, float q[4]);
+void AHRS_GetEuler(const AHRS_t *ahrs, float *roll, float *pitch, float *yaw); // 单位: 度
+
+/* 统计 */
+void AHRS_GetStats(const AHRS_t *ahrs, AHRS_Stats_t *stats);
+void AHRS_ResetStats(AHRS_t *ahrs);
+
+/**
+ * @brief 用合成数据测量单次更新的平均周期数 (使用内部临时对象)
+ * @return 平均每次更新的 CPU 周期
+ */
+uint32_t AHRS_Benchmark(AHRS_Algo_t algo, uint32_t iterations);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AHRS_H__ */
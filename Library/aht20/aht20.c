@@ -25,6 +25,8 @@ HAL_StatusTypeDef AHT20_Init(AHT20_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c)
     hdev->hi2c = hi2c;
     hdev->Temperature = 0.0f;
     hdev->Humidity = 0.0f;
+    hdev->State = AHT20_STATE_STOPPED;
+    hdev->Callback = NULL;
     uint8_t status = 0;
 
     // 上电后需等待 40ms (通常由主程序延时，这里加一个小延时确保安全)
@@ -113,6 +115,87 @@ HAL_StatusTypeDef AHT20_ReadNow(AHT20_HandleTypeDef *hdev) {
     return AHT20_GetData(hdev);
 }
 
+/* --- 内部辅助函数：非阻塞测量结束 --- */
+static HAL_StatusTypeDef AHT20_Finish(AHT20_HandleTypeDef *hdev, HAL_StatusTypeDef status) {
+    hdev->State = (hdev->Period > 0) ? AHT20_STATE_IDLE : AHT20_STATE_STOPPED;
+    if (hdev->Callback) hdev->Callback(hdev, status);
+    return status;
+}
+
+/* --- 内部辅助函数：非阻塞测量触发 --- */
+static HAL_StatusTypeDef AHT20_Begin(AHT20_HandleTypeDef *hdev) {
+    if (AHT20_TriggerMeasurement(hdev) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    hdev->TriggerTick = HAL_GetTick();
+    hdev->PollAt = AHT20_MEAS_TIME_MS;
+    hdev->State = AHT20_STATE_MEASURING;
+    return HAL_OK;
+}
+
+/**
+ * @brief  启动非阻塞测量 (单次或连续)
+ */
+HAL_StatusTypeDef AHT20_Start(AHT20_HandleTypeDef *hdev, uint32_t period_ms, AHT20_Callback cb) {
+    if (hdev->State == AHT20_STATE_MEASURING) return HAL_BUSY;
+
+    hdev->Period = period_ms;
+    hdev->Callback = cb;
+    hdev->StartTick = HAL_GetTick();
+    if (AHT20_Begin(hdev) != HAL_OK) {
+        hdev->State = AHT20_STATE_STOPPED;
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief  停止连续测量
+ */
+void AHT20_Stop(AHT20_HandleTypeDef *hdev) {
+    hdev->Period = 0;
+    hdev->State = AHT20_STATE_STOPPED;
+}
+
+/**
+ * @brief  非阻塞测量状态机
+ * @note   转换期间只比较时间; 到时读一次 7 字节, 仍忙则每 AHT20_POLL_MS 再查
+ */
+HAL_StatusTypeDef AHT20_Process(AHT20_HandleTypeDef *hdev) {
+    uint32_t elapsed;
+    HAL_StatusTypeDef status;
+
+    switch (hdev->State) {
+    case AHT20_STATE_IDLE:
+        elapsed = HAL_GetTick() - hdev->StartTick;
+        if (elapsed < hdev->Period) return HAL_BUSY;
+
+        // 按周期对齐, 落后超过一个周期则从现在重新计时
+        if (elapsed < 2 * hdev->Period) {
+            hdev->StartTick += hdev->Period;
+        } else {
+            hdev->StartTick = HAL_GetTick();
+        }
+        if (AHT20_Begin(hdev) != HAL_OK) return AHT20_Finish(hdev, HAL_ERROR);
+        return HAL_BUSY;
+
+    case AHT20_STATE_MEASURING:
+        elapsed = HAL_GetTick() - hdev->TriggerTick;
+        if (elapsed < hdev->PollAt) return HAL_BUSY;
+
+        status = AHT20_GetData(hdev);
+        if (status == HAL_BUSY) {
+            if (elapsed >= AHT20_TIMEOUT_MS) return AHT20_Finish(hdev, HAL_TIMEOUT);
+            hdev->PollAt = elapsed + AHT20_POLL_MS;
+            return HAL_BUSY;
+        }
+        return AHT20_Finish(hdev, status);
+
+    default:
+        return HAL_BUSY;
+    }
+}
+
 /**
  * @brief  软件复位
  */
@@ -20,8 +20,25 @@ extern "C" {
 #define AHT20_STATUS_BUSY      (1 << 7) // 1: 忙, 0: 就绪
 #define AHT20_STATUS_CALI      (1 << 3) // 1: 已校准
 
+/* --- 非阻塞测量参数 --- */
+#define AHT20_MEAS_TIME_MS     80   // 触发后到第一次查询的时间 (典型转换时间)
+#define AHT20_POLL_MS          5    // 仍在忙时的查询间隔
+#define AHT20_TIMEOUT_MS       200  // 触发后超过该时间仍忙则报超时
+
+/* --- 非阻塞测量状态 --- */
+typedef enum {
+    AHT20_STATE_STOPPED = 0,   // 未启动
+    AHT20_STATE_IDLE,          // 连续测量: 等待下一个周期
+    AHT20_STATE_MEASURING      // 已触发, 等待转换完成
+} AHT20_State_t;
+
+struct AHT20_Handle;
+
+/* 测量完成回调 (在 AHT20_Process 中调用), status: HAL_OK / HAL_ERROR (I2C 或 CRC) / HAL_TIMEOUT */
+typedef void (*AHT20_Callback)(struct AHT20_Handle *hdev, HAL_StatusTypeDef status);
+
 /* --- AHT20 对象句柄 --- */
-typedef struct {
+typedef struct AHT20_Handle {
     I2C_HandleTypeDef *hi2c;   // I2C句柄
     
     // 测量结果缓存
@@ -29,6 +46,14 @@ typedef struct {
     float Humidity;            // 单位: %RH
     
     uint8_t Initialized;       // 初始化标志
+
+    // 非阻塞测量 (AHT20_Start / AHT20_Process)
+    AHT20_State_t State;
+    uint32_t StartTick;        // 连续测量: 本周期起点 (按周期对齐)
+    uint32_t TriggerTick;      // 本次触发时刻
+    uint32_t PollAt;           // 下一次查询: 距触发的毫秒数
+    uint32_t Period;           // 连续测量周期 (ms), 0 为单次
+    AHT20_Callback Callback;
 } AHT20_HandleTypeDef;
 
 /* --- 函数声明 --- */
@@ -36,7 +61,7 @@ typedef struct {
 // 1. 初始化 (上电后调用)
 HAL_StatusTypeDef AHT20_Init(AHT20_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c);
 
-// 2. 简易读取 (阻塞式，耗时约 80ms)
+// 2. 简易读取 (阻塞式，耗时约 80ms; 主循环里有实时任务时用 4. 非阻塞测量)
 HAL_StatusTypeDef AHT20_ReadNow(AHT20_HandleTypeDef *hdev);
 
 // 3. 高级读取 (分步进行，用于非阻塞编程)
@@ -45,6 +70,22 @@ HAL_StatusTypeDef AHT20_TriggerMeasurement(AHT20_HandleTypeDef *hdev);
 // 第二步：在延时 >80ms 后调用此函数读取数据
 HAL_StatusTypeDef AHT20_GetData(AHT20_HandleTypeDef *hdev);
 
+// 4. 非阻塞测量 (状态机, 不调用 HAL_Delay)
+/**
+ * @brief 启动测量: 发送触发命令后立即返回, 由 AHT20_Process 完成读取
+ * @param period_ms: 0=单次测量; >0=按该周期连续测量 (芯片自热, 手册建议不快于 2s 一次)
+ * @param cb:        测量完成回调, 可为 NULL (结果照常更新到句柄)
+ * @note  正在测量时返回 HAL_BUSY
+ */
+HAL_StatusTypeDef AHT20_Start(AHT20_HandleTypeDef *hdev, uint32_t period_ms, AHT20_Callback cb);
+// 停止连续测量 (已触发的转换在芯片内自行结束)
+void AHT20_Stop(AHT20_HandleTypeDef *hdev);
+/**
+ * @brief 在主循环中调用: 未到查询时刻只比较一次时间, 不访问总线
+ * @return 本次调用完成一次测量时返回其结果 (同回调的 status), 否则返回 HAL_BUSY
+ */
+HAL_StatusTypeDef AHT20_Process(AHT20_HandleTypeDef *hdev);
+
 // 辅助：软件复位
 HAL_StatusTypeDef AHT20_SoftReset(AHT20_HandleTypeDef *hdev);
 
@@ -0,0 +1,235 @@
+#include "energy_meter.h"
+#include <stddef.h> // for offsetof
+#include <string.h> // for memset
+
+// ================= 内部函数 =================
+
+static uint32_t EMeter_Checksum(const EMeter_Persist_t *p) {
+    const uint8_t *b = (const uint8_t *)p;
+    uint32_t sum = 0;
+
+    for (uint16_t i = 0; i < offsetof(EMeter_Persist_t, checksum); i++) sum += b[i];
+    return sum;
+}
+
+static int64_t EMeter_Round(double x) {
+    return (int64_t)((x >= 0.0) ? (x + 0.5) : (x - 0.5));
+}
+
+// 电流 LSB (uA, 由 CAL 反推的精确值), 功率 LSB 为其 25 倍
+static double EMeter_CurrentLSB_uA(const EMeter_t *m) {
+    return m->hdev->CurrentLSB_uA_Q16 / 65536.0;
+}
+
+static void EMeter_ResetWindow(EMeter_t *m) {
+    m->w_n = 0;
+    m->w_us = 0;
+    m->w_charge = 0;
+    m->w_energy = 0;
+    m->w_v_min = 0xFFFF;
+    m->w_v_max = 0;
+}
+
+// ================= 外部接口实现 =================
+
+void EMeter_Init(EMeter_t *m, INA226_HandleTypeDef *hdev) {
+    memset(m, 0, sizeof(*m));
+    m->hdev = hdev;
+    // 时间戳 (INA226_TIMESTAMP) 换算到 us: 1MHz 及以上按每 us 计数, 更慢的时基 (HAL_GetTick) 按每计数 us
+    if (INA226_TIMESTAMP_HZ >= 1000000u) {
+        m->cyc_per_us = INA226_TIMESTAMP_HZ / 1000000u;
+        m->us_per_cyc = 1;
+    } else {
+        m->cyc_per_us = 1;
+        m->us_per_cyc = 1000000u / INA226_TIMESTAMP_HZ;
+    }
+    m->save_tick = HAL_GetTick();
+    EMeter_ResetWindow(m);
+    EMeter_Restart(m);
+}
+
+void EMeter_Restart(EMeter_t *m) {
+    m->period_us = INA226_GetUpdatePeriod_us(m->hdev);
+    m->cyc_frac = 0;
+    m->started = 0;
+}
+
+/**
+ * @brief 累计一次转换 (中断中调用)
+ * @note  电流 / 功率原始值乘以距上次 ALERT 的时间, 只有整数乘加
+ */
+void EMeter_OnConversion(EMeter_t *m) {
+#if EMETER_ISR_CYCLES
+    uint32_t start = DWT->CYCCNT;
+#endif
+    INA226_HandleTypeDef *hdev = m->hdev;
+    uint32_t now = hdev->ItTime;
+    uint32_t dt;
+
+    if (m->started) {
+        uint32_t cyc = now - m->last_time + m->cyc_frac;
+        dt = cyc / m->cyc_per_us;
+        m->cyc_frac = cyc - dt * m->cyc_per_us;
+        dt *= m->us_per_cyc;
+        // 时基粗于 1us 时间隔按计数量化, 判定留出一个计数的余量
+        if (dt > m->period_us + m->period_us / 2 + m->us_per_cyc - 1) m->stats.gaps++;
+    } else {
+        dt = m->period_us; // 第一次转换没有上一个沿, 按标称周期
+        m->started = 1;
+    }
+    m->last_time = now;
+
+    int16_t  i = (int16_t)hdev->Raw[INA226_REG_CURRENT];
+    uint16_t p = hdev->Raw[INA226_REG_POWER];
+
+    m->charge_acc += (int64_t)i * dt;
+    m->energy_acc += (uint64_t)p * dt;
+    m->total_us += dt;
+
+    if (m->w_n == 0) {
+        m->w_i_min = m->w_i_max = i;
+        m->w_p_max = p;
+    } else {
+        if (i < m->w_i_min) m->w_i_min = i;
+        if (i > m->w_i_max) m->w_i_max = i;
+        if (p > m->w_p_max) m->w_p_max = p;
+    }
+    if (hdev->ItDone & INA226_READ_BUS) {
+        uint16_t v = hdev->Raw[INA226_REG_BUS_VOLTAGE];
+        if (v < m->w_v_min) m->w_v_min = v;
+        if (v > m->w_v_max) m->w_v_max = v;
+    }
+    m->w_charge += (int64_t)i * dt;
+    m->w_energy += (uint64_t)p * dt;
+    m->w_us += dt;
+    m->w_n++;
+
+    m->stats.conversions++;
+#if EMETER_ISR_CYCLES
+    m->stats.isr_cycles = DWT->CYCCNT - start;
+    if (m->stats.isr_cycles > m->stats.isr_cycles_max) m->stats.isr_cycles_max = m->stats.isr_cycles;
+#endif
+}
+
+/**
+ * @brief 取出当前窗口并开始新窗口
+ */
+uint32_t EMeter_GetWindow(EMeter_t *m, EMeter_Window_t *out) {
+    INA226_HandleTypeDef *hdev = m->hdev;
+
+    // 与中断中的累加互斥: 拷贝后清零
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t n = m->w_n;
+    uint32_t us = m->w_us;
+    int64_t  charge = m->w_charge;
+    uint64_t energy = m->w_energy;
+    int16_t  i_min = m->w_i_min, i_max = m->w_i_max;
+    uint16_t p_max = m->w_p_max;
+    uint16_t v_min = m->w_v_min, v_max = m->w_v_max;
+    EMeter_ResetWindow(m);
+    __set_PRIMASK(primask);
+
+    memset(out, 0, sizeof(*out));
+    out->samples = n;
+    if (n == 0) return 0;
+
+    float i_lsb = hdev->CurrentLSB_uA_Q16 * (1e-6f / 65536.0f);
+    float p_lsb = i_lsb * 25.0f;
+
+    out->duration_s = us * 1e-6f;
+    out->i_min_a = i_min * i_lsb;
+    out->i_max_a = i_max * i_lsb;
+    out->p_max_w = p_max * p_lsb;
+    if (us > 0) {
+        out->i_avg_a = (float)charge / us * i_lsb;
+        out->p_avg_w = (float)energy / us * p_lsb;
+    }
+    if (v_max >= v_min) {
+        out->v_min_v = v_min * 0.00125f;
+        out->v_max_v = v_max * 0.00125f;
+    }
+    return n;
+}
+
+/**
+ * @brief 累计值换算 (原始值 x us x LSB = uC / uJ)
+ */
+void EMeter_GetTotals(EMeter_t *m, double *coulomb, double *joule, double *seconds) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int64_t  charge = m->charge_acc;
+    uint64_t energy = m->energy_acc;
+    uint64_t us = m->total_us;
+    __set_PRIMASK(primask);
+
+    double lsb = EMeter_CurrentLSB_uA(m);
+
+    // 原始值 x us x LSB(A) = uC, 原始值 x us x LSB(uA) = pC
+    if (coulomb) *coulomb = (m->charge_base_uC + (double)charge * lsb * 1e-6) * 1e-6;
+    if (joule)   *joule = (m->energy_base_uJ + (double)energy * lsb * 25.0 * 1e-6) * 1e-6;
+    if (seconds) *seconds = m->seconds_base + us * 1e-6;
+}
+
+void EMeter_ResetTotals(EMeter_t *m) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    m->charge_acc = 0;
+    m->energy_acc = 0;
+    m->total_us = 0;
+    __set_PRIMASK(primask);
+
+    m->charge_base_uC = 0;
+    m->energy_base_uJ = 0;
+    m->seconds_base = 0;
+}
+
+uint8_t EMeter_SaveDue(const EMeter_t *m) {
+    return (HAL_GetTick() - m->save_tick) >= EMETER_SAVE_INTERVAL_S * 1000u;
+}
+
+/**
+ * @brief 导出累计值 (换算到 uC / uJ)
+ */
+void EMeter_Export(EMeter_t *m, EMeter_Persist_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    int64_t  charge = m->charge_acc;
+    uint64_t energy = m->energy_acc;
+    uint64_t us = m->total_us;
+    __set_PRIMASK(primask);
+
+    memset(out, 0, sizeof(*out));
+    out->magic = EMETER_MAGIC;
+    out->seconds = m->seconds_base + (uint32_t)(us / 1000000u);
+    double lsb = EMeter_CurrentLSB_uA(m);
+
+    out->charge_uC = m->charge_base_uC + EMeter_Round((double)charge * lsb * 1e-6);
+    out->energy_uJ = m->energy_base_uJ + EMeter_Round((double)energy * lsb * 25.0 * 1e-6);
+    out->checksum = EMeter_Checksum(out);
+
+    m->save_tick = HAL_GetTick();
+}
+
+/**
+ * @brief 载入保存的累计值, 之后的累计在此基础上继续
+ */
+int8_t EMeter_Load(EMeter_t *m, const EMeter_Persist_t *in) {
+    if (in->magic != EMETER_MAGIC || in->checksum != EMeter_Checksum(in)) return -1;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    m->charge_acc = 0;
+    m->energy_acc = 0;
+    m->total_us = 0;
+    __set_PRIMASK(primask);
+
+    m->charge_base_uC = in->charge_uC;
+    m->energy_base_uJ = in->energy_uJ;
+    m->seconds_base = in->seconds;
+    return 0;
+}
+
+void EMeter_GetStats(const EMeter_t *m, EMeter_Stats_t *stats) {
+    *stats = m->stats;
+}
@@ -0,0 +1,137 @@
+#ifndef __ENERGY_METER_H__
+#define __ENERGY_METER_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "ina226.h"
+
+/*
+ * 电量计: INA226 转换完成中断驱动的电荷 / 能量累计.
+ *
+ * 在 INA226 转换回调里调用 EMeter_OnConversion, 每次转换只做几次整数乘加:
+ * 电流 / 功率原始值 x 本次转换间隔 (us) 累加到 64 位整数, 不用浮点, 也不受主循环抖动影响.
+ * 转换间隔取相邻两次 ALERT 沿的时间戳 (INA226_TIMESTAMP, 默认 DWT) 之差, 芯片内部时钟的误差不会带进积分;
+ * 各段间隔首尾相接, 中断延迟只影响单个采样的权重, 不会累积.
+ *
+ * 窗口统计 (最小 / 最大 / 时间加权平均) 由主循环 EMeter_GetWindow 取出并清零;
+ * 累计值只在查询 / 导出时换算成物理单位. 导出的 EMeter_Persist_t 可定期保存到
+ * EEPROM / Flash, 上电后 EMeter_Load 接着累计.
+ *
+ * INA226 需读取 INA226_READ_CURRENT | INA226_READ_POWER (加上 INA226_READ_BUS 可统计电压范围).
+ */
+
+// ================= 配置区域 =================
+
+/* EMeter_SaveDue 的保存间隔 (s) */
+#define EMETER_SAVE_INTERVAL_S  60
+
+#define EMETER_MAGIC            0x4D544D45u // "EMTM"
+
+/* 中断耗时统计用 DWT 周期计数器, 没有 DWT 的 M0/M0+ 上关闭 (isr_cycles 保持 0) */
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+#define EMETER_ISR_CYCLES       1
+#else
+#define EMETER_ISR_CYCLES       0
+#endif
+
+// ================= 数据结构 =================
+
+/* 可持久化的累计值 */
+typedef struct {
+    uint32_t magic;
+    uint32_t seconds;       // 累计计量时间 (s)
+    int64_t  charge_uC;     // 累计电荷 (uC), 符号与电流寄存器相同
+    int64_t  energy_uJ;     // 累计能量 (uJ)
+    uint32_t reserved;
+    uint32_t checksum;      // 前面各字节之和
+} EMeter_Persist_t;
+
+/* 一个统计窗口的结果 */
+typedef struct {
+    uint32_t samples;
+    float    duration_s;
+    float    i_min_a;
+    float    i_max_a;
+    float    i_avg_a;       // 按时间加权
+    float    p_max_w;
+    float    p_avg_w;
+    float    v_min_v;       // 未读 VBUS 时为 0
+    float    v_max_v;
+} EMeter_Window_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t conversions;
+    uint32_t gaps;          // 间隔超过 1.5 倍标称周期的次数 (有转换没读到)
+    uint32_t isr_cycles;    // 最近一次 EMeter_OnConversion 耗时 (CPU 周期, EMETER_ISR_CYCLES)
+    uint32_t isr_cycles_max;
+} EMeter_Stats_t;
+
+typedef struct {
+    INA226_HandleTypeDef *hdev;
+    uint32_t cyc_per_us;    // 时间戳每 us 的计数 (时基慢于 1MHz 时为 1)
+    uint32_t us_per_cyc;    // 时间戳每个计数的 us (时基 1MHz 及以上时为 1)
+    uint32_t period_us;     // 标称转换周期
+    uint32_t last_time;     // 上一次转换的 ALERT 时刻 (INA226_TIMESTAMP)
+    uint32_t cyc_frac;      // 不足 1us 的计数余数, 计入下一次
+    uint8_t  started;
+
+    // 累计 (原始值 x us)
+    int64_t  charge_acc;
+    uint64_t energy_acc;
+    uint64_t total_us;
+
+    // 导入的基数 (EMeter_Load)
+    int64_t  charge_base_uC;
+    int64_t  energy_base_uJ;
+    uint32_t seconds_base;
+
+    // 当前窗口 (原始值)
+    uint32_t w_n;
+    uint32_t w_us;
+    int64_t  w_charge;
+    uint64_t w_energy;
+    int16_t  w_i_min;
+    int16_t  w_i_max;
+    uint16_t w_p_max;
+    uint16_t w_v_min;
+    uint16_t w_v_max;
+
+    uint32_t save_tick;
+    EMeter_Stats_t stats;
+} EMeter_t;
+
+// ================= 函数声明 =================
+
+/* 初始化, 在 INA226_SetConfig 之后调用 (按当前配置取标称转换周期) */
+void   EMeter_Init(EMeter_t *m, INA226_HandleTypeDef *hdev);
+
+/* 切换 INA226 配置 / 重新启动采集后调用: 重取标称周期, 停止期间不计入, 累计值保留 */
+void   EMeter_Restart(EMeter_t *m);
+
+/* 在 INA226 转换完成回调中调用 */
+void   EMeter_OnConversion(EMeter_t *m);
+
+/* 取出当前窗口的统计并开始新窗口 (主循环中调用), 返回窗口内的采样数 */
+uint32_t EMeter_GetWindow(EMeter_t *m, EMeter_Window_t *out);
+
+/* 累计电荷 (C) / 能量 (J) / 时间 (s), 含导入的基数 */
+void   EMeter_GetTotals(EMeter_t *m, double *coulomb, double *joule, double *seconds);
+void   EMeter_ResetTotals(EMeter_t *m);
+
+/* 持久化: 距上次导出满 EMETER_SAVE_INTERVAL_S 秒时 SaveDue 返回 1 */
+uint8_t EMeter_SaveDue(const EMeter_t *m);
+void   EMeter_Export(EMeter_t *m, EMeter_Persist_t *out);
+// 校验后作为累计基数, 返回 0 成功, -1 数据无效
+int8_t EMeter_Load(EMeter_t *m, const EMeter_Persist_t *in);
+
+void   EMeter_GetStats(const EMeter_t *m, EMeter_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENERGY_METER_H__ */
@@ -0,0 +1,396 @@
+#include "energy_prof.h"
+#include <string.h> // for memset
+
+// ================= 内部状态 =================
+
+// 正在采集的对象, 标记宏通过它找到缓冲 (同一时间只有一个)
+static EProf_t * volatile s_active = NULL;
+
+// ================= 内部函数 =================
+
+/* 单次总线电压测量 (4 x 1.1ms), 只读总线电压寄存器 */
+static HAL_StatusTypeDef EProf_MeasureBus(EProf_t *prof, int32_t *bus_uv) {
+    INA226_HandleTypeDef *hdev = prof->hdev;
+    uint8_t data[2];
+
+    if (INA226_SetConfig(hdev, INA226_AVG_4, INA226_CT_1100US, INA226_CT_140US, INA226_MODE_BUS_TRIG) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    HAL_Delay(6);
+    if (HAL_I2C_Mem_Read(hdev->hi2c, hdev->Addr, INA226_REG_BUS_VOLTAGE, I2C_MEMADD_SIZE_8BIT, data, 2, 100) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    *bus_uv = (int32_t)((data[0] << 8) | data[1]) * 1250; // LSB 1.25mV
+    return HAL_OK;
+}
+
+/* 恢复采集前的配置 */
+static HAL_StatusTypeDef EProf_Restore(EProf_t *prof) {
+    uint16_t cfg = prof->saved_config;
+
+    return INA226_SetConfig(prof->hdev, (INA226_Avg_t)((cfg >> 9) & 0x07), (INA226_ConvTime_t)((cfg >> 6) & 0x07),
+                            (INA226_ConvTime_t)((cfg >> 3) & 0x07), (INA226_Mode_t)(cfg & 0x07));
+}
+
+/* 启动下一次读取: 寄存器指针不变时只收 2 字节; 出错后重写指针 */
+static void EProf_ReadNext(EProf_t *prof, uint8_t set_ptr) {
+    INA226_HandleTypeDef *hdev = prof->hdev;
+    HAL_StatusTypeDef ret;
+
+    prof->busy = 1;
+    if (set_ptr) {
+        ret = HAL_I2C_Mem_Read_IT(hdev->hi2c, hdev->Addr, INA226_REG_CURRENT, I2C_MEMADD_SIZE_8BIT, prof->rx, 2);
+    } else {
+        ret = HAL_I2C_Master_Receive_IT(hdev->hi2c, hdev->Addr, prof->rx, 2);
+    }
+    if (ret != HAL_OK) {
+        prof->busy = 0;
+        prof->running = 0;
+        prof->stats.errors++;
+    }
+}
+
+/* 记录标记: 时间 = 上一采样时刻 + 之后经过的周期 */
+static void EProf_Mark(uint8_t id, uint8_t begin) {
+    EProf_t *prof = s_active;
+    if (prof == NULL || id >= EPROF_MAX_REGIONS) return;
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (prof->running) {
+        uint16_t k = prof->n_markers;
+        if (k < EPROF_MAX_MARKERS) {
+            uint32_t cyc = DWT->CYCCNT - prof->last_time + prof->cyc_frac;
+            prof->markers[k].time_us = prof->elapsed_us + cyc / prof->cyc_per_us;
+            prof->markers[k].id = id;
+            prof->markers[k].begin = begin;
+            prof->n_markers = k + 1;
+        } else {
+            prof->stats.markers_dropped++;
+        }
+    }
+    __set_PRIMASK(primask);
+}
+
+/* 采样时间轴上单调前进的游标: 某一时刻所在的采样, 以及到该采样起点的积分 */
+typedef struct {
+    uint32_t k;   // 所在采样
+    uint32_t t0;  // 采样 k 的起点 (采样 k 覆盖 t0 ~ t0 + dt)
+    int64_t  q0;  // 0 ~ t0 的积分 (原始值 x us)
+} EProf_Cursor_t;
+
+/* 前进到时刻 t, 超出采集范围返回 0 */
+static uint8_t EProf_Seek(const EProf_t *prof, EProf_Cursor_t *c, uint32_t t) {
+    const EProf_Sample_t *s = prof->buf;
+
+    while (c->k < prof->n && c->t0 + s[c->k].dt_us <= t) {
+        c->q0 += (int64_t)s[c->k].current * s[c->k].dt_us;
+        c->t0 += s[c->k].dt_us;
+        c->k++;
+    }
+    return c->k < prof->n;
+}
+
+/* 0 ~ t 的积分, t 在游标所在采样内 */
+static int64_t EProf_Integral(const EProf_t *prof, const EProf_Cursor_t *c, uint32_t t) {
+    return c->q0 + (int64_t)prof->buf[c->k].current * (int32_t)(t - c->t0);
+}
+
+/* 一个区段结束: 原始值 x us 换算为能量, 更新该 id 的统计 */
+static void EProf_Finish(EProf_Result_t *r, int64_t acc, uint32_t us, int16_t peak, double k_uj, double k_ma) {
+    float e = (float)(acc * k_uj);
+    float ip = (float)(peak * k_ma);
+
+    if (r->count == 0 || e < r->energy_min_uj) r->energy_min_uj = e;
+    if (r->count == 0 || e > r->energy_max_uj) r->energy_max_uj = e;
+    if (r->count == 0 || ip > r->i_peak_ma) r->i_peak_ma = ip;
+    r->count++;
+    r->time_us += us;
+    r->energy_uj += e;
+}
+
+// ================= 外部接口实现 =================
+
+void EProf_Init(EProf_t *prof, INA226_HandleTypeDef *hdev, EProf_Sample_t *buf, uint32_t size) {
+    memset(prof, 0, sizeof(*prof));
+    prof->hdev = hdev;
+    prof->buf = buf;
+    prof->size = size;
+    prof->cyc_per_us = SystemCoreClock / 1000000;
+
+    // 使能 DWT 周期计数器, 用于采样与标记的时间戳
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void EProf_SetName(EProf_t *prof, uint8_t id, const char *name) {
+    if (id < EPROF_MAX_REGIONS) prof->results[id].name = name;
+}
+
+/**
+ * @brief 开始采集
+ */
+HAL_StatusTypeDef EProf_Start(EProf_t *prof) {
+    INA226_HandleTypeDef *hdev = prof->hdev;
+
+    if (hdev->ItActive || prof->busy || s_active != NULL) return HAL_BUSY;
+
+    prof->saved_config = hdev->Config;
+    if (EProf_MeasureBus(prof, &prof->bus_start_uV) != HAL_OK) {
+        EProf_Restore(prof);
+        return HAL_ERROR;
+    }
+
+    // 最快的电流转换: 1 次平均, 140us, 只测分流电压
+    if (INA226_SetConfig(hdev, INA226_AVG_1, INA226_CT_140US, INA226_CT_140US, INA226_MODE_SHUNT_CONT) != HAL_OK) {
+        EProf_Restore(prof);
+        return HAL_ERROR;
+    }
+    prof->period_us = INA226_GetUpdatePeriod_us(hdev);
+
+    // 读一次电流寄存器设好指针, 并等第一次转换完成 (之前的值是旧配置下的)
+    if (HAL_I2C_Mem_Read(hdev->hi2c, hdev->Addr, INA226_REG_CURRENT, I2C_MEMADD_SIZE_8BIT, prof->rx, 2, 100) != HAL_OK) {
+        EProf_Restore(prof);
+        return HAL_ERROR;
+    }
+    HAL_Delay(1);
+
+    prof->n = 0;
+    prof->n_markers = 0;
+    prof->elapsed_us = 0;
+    prof->cyc_frac = 0;
+    prof->bus_end_uV = prof->bus_start_uV;
+    memset(&prof->stats, 0, sizeof(prof->stats));
+
+    prof->last_time = DWT->CYCCNT;
+    prof->running = 1;
+    s_active = prof;
+    EProf_ReadNext(prof, 0);
+    if (!prof->running) {
+        s_active = NULL;
+        EProf_Restore(prof);
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+/**
+ * @brief 结束采集: 等当前读取完成, 测结束电压, 恢复配置
+ */
+HAL_StatusTypeDef EProf_Stop(EProf_t *prof) {
+    uint32_t start = HAL_GetTick();
+
+    prof->running = 0;
+    if (s_active == prof) s_active = NULL;
+
+    while (prof->busy) {
+        if (HAL_GetTick() - start > 10) return HAL_TIMEOUT;
+    }
+
+    HAL_StatusTypeDef ret = EProf_MeasureBus(prof, &prof->bus_end_uV);
+    if (ret != HAL_OK) prof->bus_end_uV = prof->bus_start_uV;
+    if (EProf_Restore(prof) != HAL_OK) ret = HAL_ERROR;
+    return ret;
+}
+
+uint8_t EProf_IsFull(const EProf_t *prof) {
+    return prof->n >= prof->size;
+}
+
+void EProf_Begin(uint8_t id) {
+    EProf_Mark(id, 1);
+}
+
+void EProf_End(uint8_t id) {
+    EProf_Mark(id, 0);
+}
+
+/**
+ * @brief 一次读取完成 (中断中调用): 记录采样并立即启动下一次读取
+ */
+void EProf_I2C_Callback(EProf_t *prof, I2C_HandleTypeDef *hi2c, int8_t status) {
+    if (hi2c != prof->hdev->hi2c || !prof->busy) return;
+
+    prof->busy = 0;
+
+    if (status != 0) {
+        // 不记采样, 这段时间并入下一个采样
+        prof->stats.errors++;
+    } else {
+        // 时间基准与采样一起更新: 更高优先级中断中的 EProf_Mark 不会看到更新了一半的时间轴
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        uint32_t now = DWT->CYCCNT;
+        uint32_t cyc = now - prof->last_time + prof->cyc_frac;
+        uint32_t dt = cyc / prof->cyc_per_us;
+        prof->cyc_frac = cyc - dt * prof->cyc_per_us;
+        prof->last_time = now;
+
+        if (dt > prof->period_us) prof->stats.slow_reads++;
+        if (dt > 0xFFFF) dt = 0xFFFF; // 中断被长时间屏蔽, 时间轴在此处缩短
+        prof->stats.samples++;
+
+        if (prof->running) {
+            uint32_t n = prof->n;
+            if (n < prof->size) {
+                prof->buf[n].current = (int16_t)((prof->rx[0] << 8) | prof->rx[1]);
+                prof->buf[n].dt_us = (uint16_t)dt;
+                prof->elapsed_us += dt;
+                prof->n = ++n;
+            }
+            if (n >= prof->size) prof->running = 0; // 缓冲已满
+        }
+        __set_PRIMASK(primask);
+    }
+
+    if (prof->running) EProf_ReadNext(prof, status != 0);
+}
+
+/**
+ * @brief 按标记统计各区段
+ * @note  读数是一次转换 (w) 内的平均电流, 电流阶跃在时间轴上被抹成宽 w 的斜坡,
+ *        直接按标记截取会在每个边界漏掉约 dI x w / 4. 这里把区段两端各扩展 w / 2,
+ *        再减去扩展部分按区段外侧电流 (距边界 w 处的读数) 计算的量, 阶跃变化时结果无偏.
+ */
+uint8_t EProf_Analyze(EProf_t *prof) {
+    const EProf_Sample_t *s = prof->buf;
+    uint32_t n = prof->n;
+    uint16_t nm = prof->n_markers;
+
+    // 各 id 进行中的区段
+    uint32_t open = 0;
+    int64_t  q_begin[EPROF_MAX_REGIONS];  // 扩展起点处的积分
+    uint32_t k_begin[EPROF_MAX_REGIONS];  // 扩展起点所在的采样
+    uint32_t t_begin[EPROF_MAX_REGIONS];
+    int16_t  i_before[EPROF_MAX_REGIONS]; // 区段前的电流
+    int64_t  charge[EPROF_MAX_REGIONS];   // 各次区段合计 (原始值 x us)
+
+    // 原始值 x us x LSB(uA) = pC, pC x uV = 1e-12 uJ
+    double lsb_ua = prof->hdev->CurrentLSB_uA_Q16 / 65536.0;
+    double bus_uv = ((double)prof->bus_start_uV + prof->bus_end_uV) * 0.5;
+    double k_uj = lsb_ua * bus_uv * 1e-12;
+    double k_ma = lsb_ua * 1e-3;
+
+    for (uint8_t id = 0; id < EPROF_MAX_REGIONS; id++) {
+        const char *name = prof->results[id].name;
+        memset(&prof->results[id], 0, sizeof(EProf_Result_t));
+        prof->results[id].name = name;
+        charge[id] = 0;
+    }
+    memset(&prof->total, 0, sizeof(prof->total));
+    prof->total.name = "total";
+    prof->stats.unmatched = 0;
+    prof->stats.truncated = 0;
+    if (n == 0) return 0;
+
+    // 读数延迟: 转换窗口中心在数据锁存前 w / 2, 锁存约在读取的前 1/3 处 (地址字节之后),
+    // 采样区间中心在读取完成前半个间隔 -> 标记时间加上 w / 2 + (w / 2 + 2/3 dt - dt / 2)
+    uint32_t w = prof->period_us;
+    uint32_t g = w / 2;
+    uint32_t lag = w + prof->elapsed_us / n / 6;
+    EProf_Cursor_t c_before = {0}, c_begin = {0}, c_end = {0}, c_after = {0};
+    uint16_t m;
+
+    for (m = 0; m < nm; m++) {
+        const EProf_Marker_t *mk = &prof->markers[m];
+        uint8_t  id = mk->id;
+        uint32_t bit = 1u << id;
+        uint32_t t = mk->time_us + lag;
+
+        if (mk->begin) {
+            if (!EProf_Seek(prof, &c_begin, t - g)) break; // 之后的标记都超出了采集范围
+            EProf_Seek(prof, &c_before, t - w);
+            if (open & bit) prof->stats.unmatched++; // 上一次没有 End, 丢弃
+            open |= bit;
+            q_begin[id] = EProf_Integral(prof, &c_begin, t - g);
+            k_begin[id] = c_begin.k;
+            t_begin[id] = t;
+            i_before[id] = s[c_before.k].current;
+        } else {
+            if (!(open & bit)) {
+                prof->stats.unmatched++;
+                continue;
+            }
+            if (!EProf_Seek(prof, &c_after, t + w)) break;
+            EProf_Seek(prof, &c_end, t + g);
+            open &= ~bit;
+
+            int64_t acc = EProf_Integral(prof, &c_end, t + g) - q_begin[id]
+                        - (int64_t)g * (i_before[id] + s[c_after.k].current);
+            int16_t peak = s[k_begin[id]].current;
+            for (uint32_t k = k_begin[id] + 1; k <= c_end.k; k++) {
+                if (s[k].current > peak) peak = s[k].current;
+            }
+            charge[id] += acc;
+            EProf_Finish(&prof->results[id], acc, t - t_begin[id], peak, k_uj, k_ma);
+        }
+    }
+
+    // 采集结束时仍在进行的区段, 以及之后才开始的区段
+    for (uint8_t id = 0; id < EPROF_MAX_REGIONS; id++) {
+        if (open & (1u << id)) prof->stats.truncated++;
+    }
+    for (; m < nm; m++) {
+        if (prof->markers[m].begin) prof->stats.truncated++;
+    }
+
+    uint8_t regions = 0;
+    for (uint8_t id = 0; id < EPROF_MAX_REGIONS; id++) {
+        EProf_Result_t *r = &prof->results[id];
+        if (r->count == 0) continue;
+        if (r->time_us > 0) r->i_avg_ma = (float)(charge[id] * k_ma / r->time_us);
+        regions++;
+    }
+
+    // 整个采集
+    int64_t total_acc = 0;
+    int16_t total_peak = s[0].current;
+    for (uint32_t k = 0; k < n; k++) {
+        total_acc += (int64_t)s[k].current * s[k].dt_us;
+        if (s[k].current > total_peak) total_peak = s[k].current;
+    }
+    EProf_Finish(&prof->total, total_acc, prof->elapsed_us, total_peak, k_uj, k_ma);
+    if (prof->elapsed_us > 0) prof->total.i_avg_ma = (float)(total_acc * k_ma / prof->elapsed_us);
+    return regions;
+}
+
+const EProf_Result_t *EProf_GetResult(const EProf_t *prof, uint8_t id) {
+    return (id < EPROF_MAX_REGIONS) ? &prof->results[id] : NULL;
+}
+
+const EProf_Result_t *EProf_GetTotal(const EProf_t *prof) {
+    return &prof->total;
+}
+
+const EProf_Sample_t *EProf_GetSamples(const EProf_t *prof, uint32_t *n) {
+    if (n) *n = prof->n;
+    return prof->buf;
+}
+
+/**
+ * @brief 与基线比较, 结果写入各区段的 regressed
+ */
+uint8_t EProf_Compare(EProf_t *prof, const EProf_Baseline_t *base, uint8_t n, uint8_t tol_pct) {
+    float k = 1.0f + tol_pct * 0.01f;
+    uint8_t bad = 0;
+
+    for (uint8_t j = 0; j < n; j++) {
+        if (base[j].id >= EPROF_MAX_REGIONS) continue;
+        EProf_Result_t *r = &prof->results[base[j].id];
+        uint8_t reg = 0;
+
+        if (r->count == 0) {
+            reg = 1;
+        } else {
+            if (base[j].energy_uj > 0.0f && r->energy_uj / r->count > base[j].energy_uj * k) reg = 1;
+            if (base[j].i_peak_ma > 0.0f && r->i_peak_ma > base[j].i_peak_ma * k) reg = 1;
+        }
+        r->regressed = reg;
+        bad += reg;
+    }
+    return bad;
+}
+
+void EProf_GetStats(const EProf_t *prof, EProf_Stats_t *stats) {
+    *stats = prof->stats;
+}
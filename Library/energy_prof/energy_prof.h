@@ -0,0 +1,173 @@
+#ifndef __ENERGY_PROF_H__
+#define __ENERGY_PROF_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "ina226.h"
+
+/*
+ * 固件能耗剖析: INA226 以最快速度采样电流写入 RAM, 代码中插入区段标记,
+ * 采集结束后按标记统计每类操作 (W25Q 擦除 / IMU FIFO 读取 / I2S 一块数据 ...) 的能量与峰值电流.
+ *
+ * 采集: INA226 设为 AVG_1 + 140us + 只测分流电压连续模式 (约 7.1k 次/s), 电流寄存器
+ * 指针设好后只发 2 字节的读 (400kHz 下约 70us), 读完立即再读, 读取间隔小于转换时间,
+ * 每次转换至少被读到一次. 每个采样记录电流原始值和距上一采样的时间 (DWT 计数换算),
+ * 能量按 "电流 x 时间" 积分, 读到同一次转换两遍不影响结果.
+ *
+ * 标记: EPROF_BEGIN(id) / EPROF_END(id) 可放在任意代码里 (含中断), 只记一个时间戳;
+ * 同一 id 可以反复出现, 不同 id 可以嵌套或交叠.
+ *
+ * 分析: 读数相对真实电流有固定延迟 (一次转换 + 半次读取), 统计时自动补偿;
+ * 标记落在一个采样中间时按时间比例分摊. 采集期间只测电流, 电压取开始与结束时
+ * 各测一次的平均值 (适用于稳压供电的电源轨).
+ *
+ * 采集期间独占 INA226 所在的 I2C, 同一总线上的其他设备不能访问.
+ */
+
+// ================= 配置区域 =================
+
+/* 0=标记宏为空 (正式固件中去掉剖析代码) */
+#ifndef EPROF_ENABLE
+#define EPROF_ENABLE         1
+#endif
+
+/* 区段 id 数量 (0 ~ N-1, 不超过 32) */
+#define EPROF_MAX_REGIONS    16
+
+/* 一次采集最多标记数 (每次 Begin / End 各占一个, 8 字节) */
+#define EPROF_MAX_MARKERS    256
+
+// ================= 数据结构 =================
+
+/* 一个采样 (4 字节): 64KB 缓冲约可记录 1.1s */
+typedef struct {
+    int16_t  current;   // 电流寄存器原始值
+    uint16_t dt_us;     // 距上一采样的时间
+} EProf_Sample_t;
+
+/* 区段标记 */
+typedef struct {
+    uint32_t time_us;   // 距采集开始的时间
+    uint8_t  id;
+    uint8_t  begin;     // 1=Begin, 0=End
+} EProf_Marker_t;
+
+/* 一个区段 id 的统计 (EProf_Analyze 之后有效) */
+typedef struct {
+    const char *name;
+    uint32_t count;          // 完整 (Begin ... End) 出现的次数
+    uint32_t time_us;        // 总时长
+    float    energy_uj;      // 总能量
+    float    energy_min_uj;  // 单次最小 / 最大能量
+    float    energy_max_uj;
+    float    i_avg_ma;       // 区段内平均电流
+    float    i_peak_ma;      // 区段内采样的最大电流
+    uint8_t  regressed;      // EProf_Compare 判定超出基线
+} EProf_Result_t;
+
+/* 回归基线: 单次能量与峰值电流上限 (0 表示不检查) */
+typedef struct {
+    uint8_t  id;
+    float    energy_uj;      // 单次平均能量
+    float    i_peak_ma;
+} EProf_Baseline_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t samples;        // 采样数 (含缓冲满后丢弃的)
+    uint32_t slow_reads;     // 读取间隔超过转换时间 (可能漏掉一次转换, I2C 需 400kHz)
+    uint32_t markers_dropped;// 标记缓冲满丢弃的标记
+    uint32_t unmatched;      // 没有配对的 Begin / End
+    uint32_t truncated;      // 采集结束时仍未结束的区段
+    uint32_t errors;         // I2C 启动或传输失败
+} EProf_Stats_t;
+
+typedef struct {
+    INA226_HandleTypeDef *hdev;
+    EProf_Sample_t *buf;
+    uint32_t size;
+    volatile uint32_t n;     // 已记录的采样
+    volatile uint8_t  running;
+    volatile uint8_t  busy;  // 正在读取
+    uint8_t  rx[2];
+
+    // 时间基准 (中断中更新)
+    uint32_t cyc_per_us;
+    uint32_t last_time;      // 上一采样的 DWT 计数
+    uint32_t cyc_frac;       // 不足 1us 的周期余数
+    volatile uint32_t elapsed_us;
+
+    EProf_Marker_t markers[EPROF_MAX_MARKERS];
+    volatile uint16_t n_markers;
+
+    uint16_t saved_config;   // 采集前的配置寄存器, 结束后恢复
+    uint32_t period_us;      // 转换时间
+    int32_t  bus_start_uV;
+    int32_t  bus_end_uV;
+
+    EProf_Result_t results[EPROF_MAX_REGIONS];
+    EProf_Result_t total;    // 整个采集
+    EProf_Stats_t  stats;
+} EProf_t;
+
+// ================= 函数声明 =================
+
+/* 初始化, buf 为采样缓冲 (静态数组, 可放 CCM RAM) */
+void   EProf_Init(EProf_t *prof, INA226_HandleTypeDef *hdev, EProf_Sample_t *buf, uint32_t size);
+
+/* 区段名称 (只保存指针, 用于输出) */
+void   EProf_SetName(EProf_t *prof, uint8_t id, const char *name);
+
+/**
+ * @brief 开始采集: 测一次电压, 切到最快的电流连续转换, 启动中断读取
+ * @note  阻塞约 10ms; INA226 中断采集 (INA226_IT_Start) 期间返回 HAL_BUSY
+ */
+HAL_StatusTypeDef EProf_Start(EProf_t *prof);
+
+/* 结束采集 (缓冲写满时采集会自动停下, 仍需调用): 再测一次电压, 恢复原配置 */
+HAL_StatusTypeDef EProf_Stop(EProf_t *prof);
+
+/* 缓冲是否已满 (采集已自动停止) */
+uint8_t EProf_IsFull(const EProf_t *prof);
+
+/* 区段标记, 作用于正在采集的对象, 未采集时为空操作 (可在中断中调用) */
+void   EProf_Begin(uint8_t id);
+void   EProf_End(uint8_t id);
+
+#if EPROF_ENABLE
+#define EPROF_BEGIN(id)  EProf_Begin(id)
+#define EPROF_END(id)    EProf_End(id)
+#else
+#define EPROF_BEGIN(id)  ((void)0)
+#define EPROF_END(id)    ((void)0)
+#endif
+
+/* 在 HAL_I2C_MasterRxCpltCallback / HAL_I2C_MemRxCpltCallback (status = 0)
+ * 与 HAL_I2C_ErrorCallback (status = -1) 中调用 */
+void   EProf_I2C_Callback(EProf_t *prof, I2C_HandleTypeDef *hi2c, int8_t status);
+
+/* 采集结束后统计各区段, 返回出现过的区段数 */
+uint8_t EProf_Analyze(EProf_t *prof);
+
+const EProf_Result_t *EProf_GetResult(const EProf_t *prof, uint8_t id);
+const EProf_Result_t *EProf_GetTotal(const EProf_t *prof);
+
+/* 原始采样 (用于导出波形), n 返回采样数 */
+const EProf_Sample_t *EProf_GetSamples(const EProf_t *prof, uint32_t *n);
+
+/**
+ * @brief 与基线比较: 单次平均能量或峰值电流超过基线 (1 + tol_pct%) 的区段记为回归
+ * @return 回归的区段数; 基线中的区段本次没有出现也计为回归
+ */
+uint8_t EProf_Compare(EProf_t *prof, const EProf_Baseline_t *base, uint8_t n, uint8_t tol_pct);
+
+void   EProf_GetStats(const EProf_t *prof, EProf_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ENERGY_PROF_H__ */
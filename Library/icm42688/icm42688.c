@@ -1,13 +1,33 @@
 #include "icm42688.h"
-#include <string.h> // for memset
+#include <string.h> // for memset, memcpy
+#include <math.h>   // for cosf
+
+// FIFO 突发读取缓冲 (所有设备共用, 非可重入), 第 0 字节为地址, 按高精度包长度分配
+static uint8_t s_fifo_buf[1 + ICM_FIFO_BURST_MAX * ICM_FIFO_PKT4_LEN];
 
 // ================= 内部静态辅助函数 (底层接口) =================
 
-static void ICM_CS_Low(ICM42688_t *dev) {
+// 片选拉低; 挂在总线上时先占用总线, 超时返回 -1 (不拉片选, 不能再调用 ICM_CS_High)
+static int8_t ICM_CS_Low(ICM42688_t *dev) {
+#if ICM_USE_SPI_BUS
+    if (dev->bus_dev != NULL) {
+        if (SPIBus_Acquire(dev->bus_dev, 10) != 0) return -1;
+        SPIBus_Select(dev->bus_dev);
+        return 0;
+    }
+#endif
     HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_RESET);
+    return 0;
 }
 
 static void ICM_CS_High(ICM42688_t *dev) {
+#if ICM_USE_SPI_BUS
+    if (dev->bus_dev != NULL) {
+        SPIBus_Deselect(dev->bus_dev);
+        SPIBus_Release(dev->bus_dev);
+        return;
+    }
+#endif
     HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_SET);
 }
 
@@ -17,51 +37,264 @@ static int8_t ICM_WriteReg(ICM42688_t *dev, uint8_t reg, uint8_t value) {
     data[0] = reg & 0x7F; // 写操作，最高位为0
     data[1] = value;
 
-    ICM_CS_Low(dev);
+    if (ICM_CS_Low(dev) != 0) return -1;
     HAL_StatusTypeDef status = HAL_SPI_Transmit(dev->hspi, data, 2, 10);
     ICM_CS_High(dev);
 
     return (status == HAL_OK) ? 0 : -1;
 }
 
-// SPI 读寄存器
-static int8_t ICM_ReadRegs(ICM42688_t *dev, uint8_t reg, uint8_t *buffer, uint16_t len) {
-    uint8_t tx_data = reg | 0x80; // 读操作，最高位为1
-    HAL_StatusTypeDef status;
+// SPI 读寄存器帧: 一次全双工事务, frame[0] 放地址, 数据从 frame[1] 开始
+// 收发共用同一缓冲: 发送总是领先接收, 每个字节都是先发出再被覆盖
+static int8_t ICM_ReadFrame(ICM42688_t *dev, uint8_t reg, uint8_t *frame, uint16_t len) {
+    frame[0] = reg | 0x80; // 读操作，最高位为1
 
-    ICM_CS_Low(dev);
-    // 发送寄存器地址
-    status = HAL_SPI_Transmit(dev->hspi, &tx_data, 1, 10);
-    if (status == HAL_OK) {
-        // 接收数据
-        status = HAL_SPI_Receive(dev->hspi, buffer, len, 10);
-    }
+    if (ICM_CS_Low(dev) != 0) return -1;
+    HAL_StatusTypeDef status = HAL_SPI_TransmitReceive(dev->hspi, frame, frame, len + 1, 10);
     ICM_CS_High(dev);
 
     return (status == HAL_OK) ? 0 : -1;
 }
 
-// 切换寄存器 Bank
+// SPI 读寄存器 (len <= ICM_FRAME_MAX)
+static int8_t ICM_ReadRegs(ICM42688_t *dev, uint8_t reg, uint8_t *buffer, uint16_t len) {
+    if (len > ICM_FRAME_MAX) return -1;
+    if (ICM_ReadFrame(dev, reg, dev->frame, len) != 0) return -1;
+
+    memcpy(buffer, &dev->frame[1], len);
+    return 0;
+}
+
+// 切换寄存器 Bank, 与缓存相同时不产生 SPI 事务
 static int8_t ICM_SetBank(ICM42688_t *dev, uint8_t bank) {
-    return ICM_WriteReg(dev, ICM42688_REG_BANK_SEL, bank);
+    if (dev->bank == bank) return 0;
+    if (ICM_WriteReg(dev, ICM42688_REG_BANK_SEL, bank) != 0) {
+        dev->bank = 0xFF; // 写失败则状态未知, 下次强制重写
+        return -1;
+    }
+    dev->bank = bank;
+    return 0;
 }
 
-// ================= 外部接口实现 =================
+// 读-改-写当前 Bank 中的寄存器位
+static int8_t ICM_UpdateBits(ICM42688_t *dev, uint8_t reg, uint8_t mask, uint8_t value) {
+    uint8_t v = 0;
+    if (ICM_ReadRegs(dev, reg, &v, 1) != 0) return -1;
+    v = (v & ~mask) | (value & mask);
+    return ICM_WriteReg(dev, reg, v);
+}
 
-/**
- * @brief 初始化 ICM42688 设备
- */
-int8_t ICM42688_Init(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port, ICM_GPIO_Pin cs_pin) {
-    if (dev == NULL || hspi == NULL) return -1;
+// 解析 TEMP_DATA1 开始的 14 字节数据寄存器 (大端)
+static void ICM_ParseRegs(const uint8_t *buffer, ICM_RawData_t *raw) {
+    raw->temp_raw    = (int16_t)((buffer[0] << 8) | buffer[1]);
+    raw->accel_x_raw = (int16_t)((buffer[2] << 8) | buffer[3]);
+    raw->accel_y_raw = (int16_t)((buffer[4] << 8) | buffer[5]);
+    raw->accel_z_raw = (int16_t)((buffer[6] << 8) | buffer[7]);
+    raw->gyro_x_raw  = (int16_t)((buffer[8] << 8) | buffer[9]);
+    raw->gyro_y_raw  = (int16_t)((buffer[10] << 8) | buffer[11]);
+    raw->gyro_z_raw  = (int16_t)((buffer[12] << 8) | buffer[13]);
+    raw->timestamp   = 0;
+}
+
+// 解析 FIFO 包 3, 返回有效包数
+// 包 3 中温度只有 8 位 (1 LSB = 1/2.07 C), 乘 64 换算到与 TEMP_DATA 相同的刻度
+static uint16_t ICM_ParseFifo(const uint8_t *buffer, uint16_t count, ICM_RawData_t *out) {
+    uint16_t n = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *p = &buffer[i * ICM_FIFO_PKT3_LEN];
+
+        if (p[0] & ICM_FIFO_HEADER_MSG) break; // FIFO 已空
+        if ((p[0] & (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO)) !=
+            (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO)) continue;
+
+        ICM_RawData_t *r = &out[n++];
+        r->accel_x_raw = (int16_t)((p[1] << 8) | p[2]);
+        r->accel_y_raw = (int16_t)((p[3] << 8) | p[4]);
+        r->accel_z_raw = (int16_t)((p[5] << 8) | p[6]);
+        r->gyro_x_raw  = (int16_t)((p[7] << 8) | p[8]);
+        r->gyro_y_raw  = (int16_t)((p[9] << 8) | p[10]);
+        r->gyro_z_raw  = (int16_t)((p[11] << 8) | p[12]);
+        r->temp_raw    = (int16_t)((int8_t)p[13] * 64);
+        r->timestamp   = (uint16_t)((p[14] << 8) | p[15]); // 尚未展开
+    }
+    return n;
+}
+
+// 时间关联环路增益: 相位 (参考点) 与频率 (rate)
+#define ICM_TS_K_PHASE 0.25f
+#define ICM_TS_K_RATE  0.0625f
+
+// 16 位芯片时间戳展开为 32 位: 与上一次展开值的差按有符号 16 位解释
+// 比上一次更早的值 (如同一批中靠前的包) 不推进 imu_last
+static uint32_t ICM_TS_Extend(ICM42688_t *dev, uint16_t raw) {
+    ICM_TimeSync_t *ts = &dev->ts;
+
+    if (!ts->imu_valid) {
+        ts->imu_last = raw;
+        ts->imu_valid = 1;
+        return raw;
+    }
+
+    int16_t delta = (int16_t)(raw - (uint16_t)ts->imu_last);
+    uint32_t ext = ts->imu_last + (int32_t)delta;
+    if (delta > 0) ts->imu_last = ext;
+    return ext;
+}
+
+// 把一批 FIFO 采样的 16 位时间戳展开 (原地)
+static void ICM_TS_ExtendSamples(ICM42688_t *dev, ICM_RawData_t *samples, uint16_t n) {
+    for (uint16_t i = 0; i < n; i++) {
+        samples[i].timestamp = ICM_TS_Extend(dev, (uint16_t)samples[i].timestamp);
+    }
+}
+
+// ================= 定点换算 =================
+
+// Cortex-M4 DSP 扩展: 一条 SMLAD 同时完成 raw * gain 与 offset 的累加
+#if defined(__ARM_FEATURE_DSP) && (__ARM_FEATURE_DSP == 1)
+#define ICM_Q15_USE_DSP 1
+#else
+#define ICM_Q15_USE_DSP 0
+#endif
+
+// 按当前量程合成 Q15 系数: gain 右移 (参考量程 - 当前量程) 位, offset 按结果移位预乘后放高半字
+// 加速度增益 = accel_gain x gain_q15, 可以大于 1: 低于参考量程时右移留出了余量,
+// 处在参考量程 (16g) 时改用 Q14 系数 (结果右移 14 位), 增益上限为 2.0
+static void ICM_UpdateQ15Coef(ICM42688_t *dev) {
+    uint8_t ash = (dev->accel_fs_shift < ICM_Q15_ACCEL_REF_SHIFT) ? 15 : 14;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        uint8_t fs = (i < 3) ? dev->accel_fs_shift : dev->gyro_fs_shift;
+        uint8_t ref = (i < 3) ? ICM_Q15_ACCEL_REF_SHIFT : ICM_Q15_GYRO_REF_SHIFT;
+        uint8_t sh = (i < 3) ? ash : 15;
+        int16_t gain;
+
+        if (i < 3) {
+            float g = dev->accel_gain[i] * dev->q15_cal.gain_q15[i] * (float)(1u << (sh - (ref - fs))) / 32768.0f;
+            gain = (int16_t)(g + 0.5f); // ICM42688_SetAccelGain 已限制 gain < 2.0, 不会溢出
+        } else {
+            gain = (int16_t)(dev->q15_cal.gain_q15[i] >> (ref - fs));
+        }
+        int16_t offset_hi = (int16_t)(dev->q15_cal.offset[i] * (1 << (sh - 14)));
+
+        dev->q15_coef[i] = (uint16_t)gain | ((uint32_t)(uint16_t)offset_hi << 16);
+    }
+    dev->q15_accel_shift = ash;
+}
+
+// 单轴换算: (raw * gain + offset_hi * 0x4000 + 舍入) >> sh, 饱和到 16 位 (sh = 15, 16g 加速度为 14)
+// DSP 下 raw 放低半字, 0x4000 放高半字, 与系数做一次双乘加; 舍入为 1 << (sh - 1)
+#if ICM_Q15_USE_DSP
+static inline int16_t ICM_Q15Apply(uint32_t pair, uint32_t coef, uint8_t sh) {
+    int32_t acc = (int32_t)__SMLAD(pair, coef, 1u << (sh - 1));
+    return (int16_t)__SSAT(acc >> sh, 16);
+}
+#define ICM_Q15_LO(w) __PKHBT((w), 0x4000, 16)       // 低半字 + 0x4000
+#define ICM_Q15_HI(w) __PKHTB(0x40000000, (w), 16)   // 高半字 + 0x4000
+#else
+static inline int16_t ICM_Q15Apply(int16_t raw, uint32_t coef, uint8_t sh) {
+    int32_t acc = (int32_t)raw * (int16_t)coef + (int32_t)(int16_t)(coef >> 16) * 0x4000 + (1 << (sh - 1));
+    acc >>= sh;
+    if (acc > 32767) acc = 32767;
+    if (acc < -32768) acc = -32768;
+    return (int16_t)acc;
+}
+#endif
+
+// 从 FIFO 包 (p[1..12] 大端 Accel/Gyro) 直接换算
+static void ICM_Q15FromPacket(const uint8_t *p, const uint32_t *coef, uint8_t ash, ICM_Q15Data_t *out) {
+#if ICM_Q15_USE_DSP
+    // 三个 32 位字各含两轴, REV16 一次完成两轴的大小端交换
+    uint32_t w[3];
+    memcpy(w, &p[1], sizeof(w));
+    w[0] = __REV16(w[0]); // Ax | Ay
+    w[1] = __REV16(w[1]); // Az | Gx
+    w[2] = __REV16(w[2]); // Gy | Gz
+
+    out->accel[0] = ICM_Q15Apply(ICM_Q15_LO(w[0]), coef[0], ash);
+    out->accel[1] = ICM_Q15Apply(ICM_Q15_HI(w[0]), coef[1], ash);
+    out->accel[2] = ICM_Q15Apply(ICM_Q15_LO(w[1]), coef[2], ash);
+    out->gyro[0]  = ICM_Q15Apply(ICM_Q15_HI(w[1]), coef[3], 15);
+    out->gyro[1]  = ICM_Q15Apply(ICM_Q15_LO(w[2]), coef[4], 15);
+    out->gyro[2]  = ICM_Q15Apply(ICM_Q15_HI(w[2]), coef[5], 15);
+#else
+    for (uint8_t i = 0; i < 3; i++) {
+        out->accel[i] = ICM_Q15Apply((int16_t)((p[1 + i * 2] << 8) | p[2 + i * 2]), coef[i], ash);
+        out->gyro[i]  = ICM_Q15Apply((int16_t)((p[7 + i * 2] << 8) | p[8 + i * 2]), coef[3 + i], 15);
+    }
+#endif
+}
+
+// 拼接 20 位数据 ([19:12], [11:4], [3:0]) 并符号扩展
+static inline int32_t ICM_HiResValue(uint8_t hi, uint8_t lo, uint8_t ext4) {
+    int32_t v = ((int32_t)hi << 12) | ((int32_t)lo << 4) | (ext4 & 0x0F);
+    return (v ^ 0x80000) - 0x80000;
+}
+
+// 解析 FIFO 包 4, 返回有效包数
+// 扩展字节 p[17..19]: 高 4 位为 Accel X/Y/Z 的 [3:0], 低 4 位为 Gyro X/Y/Z 的 [3:0]
+static uint16_t ICM_ParseFifoHiRes(const uint8_t *buffer, uint16_t count, ICM_HiResData_t *out) {
+    uint16_t n = 0;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *p = &buffer[i * ICM_FIFO_PKT4_LEN];
+
+        if (p[0] & ICM_FIFO_HEADER_MSG) break; // FIFO 已空
+        if ((p[0] & (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO | ICM_FIFO_HEADER_20)) !=
+            (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO | ICM_FIFO_HEADER_20)) continue;
 
+        ICM_HiResData_t *r = &out[n++];
+        r->accel_x = ICM_HiResValue(p[1], p[2], p[17] >> 4);
+        r->accel_y = ICM_HiResValue(p[3], p[4], p[18] >> 4);
+        r->accel_z = ICM_HiResValue(p[5], p[6], p[19] >> 4);
+        r->gyro_x  = ICM_HiResValue(p[7], p[8], p[17]);
+        r->gyro_y  = ICM_HiResValue(p[9], p[10], p[18]);
+        r->gyro_z  = ICM_HiResValue(p[11], p[12], p[19]);
+        r->temp_raw  = (int16_t)((p[13] << 8) | p[14]);
+        r->timestamp = (uint16_t)((p[15] << 8) | p[16]); // 尚未展开
+    }
+    return n;
+}
+
+// ================= 外部接口实现 =================
+
+// 初始化公共部分 (bus_dev 已由调用者设置)
+static int8_t ICM_Setup(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port, ICM_GPIO_Pin cs_pin) {
     // 1. 绑定句柄
     dev->hspi = hspi;
     dev->cs_port = cs_port;
     dev->cs_pin = cs_pin;
     dev->initialized = 0;
+    dev->fifo_mode = ICM_FIFO_BYPASS;
+    dev->fifo_pkt_len = ICM_FIFO_PKT3_LEN;
+    dev->fifo_hires = 0;
+    dev->apex_odr = ICM_DMP_ODR_50HZ;
+    dev->apex_features = 0;
+    dev->apex_wom = 0;
+    dev->it_mode = ICM_IT_NONE;
+    dev->it_busy = 0;
     
-    // 初始化 CS 引脚状态
-    ICM_CS_High(dev);
+    dev->bank = 0xFF; // 上电后 Bank 未知, 第一次必须真正写入
+    ICM42688_TS_Reset(dev);
+
+    // Q15 校准默认为单位增益, 零偏移; 复位后芯片用户偏移为 0
+    for (uint8_t i = 0; i < 6; i++) {
+        dev->q15_cal.gain_q15[i] = 32767;
+        dev->q15_cal.offset[i] = 0;
+        dev->offset_user[i] = 0;
+    }
+    for (uint8_t i = 0; i < 3; i++) dev->accel_gain[i] = 1.0f;
+
+    // 复位后量程为 16g / 2000dps; 换算系数在设置量程前就要有效 (Q15 系数同时用到两个移位)
+    dev->accel_scale = 16.0f / 32768.0f;
+    dev->gyro_scale = 2000.0f / 32768.0f;
+    dev->accel_fs_shift = 4;
+    dev->gyro_fs_shift = 4;
+    ICM_UpdateQ15Coef(dev);
+    
+    // 初始化 CS 引脚状态 (挂在总线上时同样直接拉高, 此时未占用总线)
+    HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_SET);
     HAL_Delay(10); // 上电等待
 
     // 2. 软件复位 (Optional, but recommended)
@@ -70,6 +303,7 @@ int8_t ICM42688_Init(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port
     // 复位设备 (Device Config 寄存器，位 0) - 具体地址视手册，通常在 Bank 0 0x11
     ICM_WriteReg(dev, 0x11, 0x01); 
     HAL_Delay(100); // 等待复位完成
+    dev->bank = 0;  // 复位后回到 Bank 0
 
     // 3. 检查 Device ID
     uint8_t who_am_i = 0;
@@ -98,6 +332,30 @@ int8_t ICM42688_Init(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port
     return 0;
 }
 
+/**
+ * @brief 初始化 ICM42688 设备
+ */
+int8_t ICM42688_Init(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port, ICM_GPIO_Pin cs_pin) {
+    if (dev == NULL || hspi == NULL) return -1;
+
+#if ICM_USE_SPI_BUS
+    dev->bus_dev = NULL; // 独占 SPI (句柄可能未清零)
+#endif
+    return ICM_Setup(dev, hspi, cs_port, cs_pin);
+}
+
+#if ICM_USE_SPI_BUS
+/**
+ * @brief 通过总线仲裁器初始化 ICM42688
+ */
+int8_t ICM42688_InitOnBus(ICM42688_t *dev, SPIBus_Device_t *bus_dev) {
+    if (dev == NULL || bus_dev == NULL || bus_dev->bus->hspi == NULL) return -1;
+
+    dev->bus_dev = bus_dev;
+    return ICM_Setup(dev, bus_dev->bus->hspi, bus_dev->cs_port, bus_dev->cs_pin);
+}
+#endif
+
 /**
  * @brief 设置加速度计配置
  */
@@ -108,15 +366,17 @@ int8_t ICM42688_SetAccelConfig(ICM42688_t *dev, ICM_AccelRange_t range, ICM_ODR_
     uint8_t config = (range << 5) | (odr & 0x0F);
     
     if (ICM_WriteReg(dev, ICM42688_ACCEL_CONFIG0, config) != 0) return -1;
+    dev->accel_config0 = config;
 
     // 更新换算系数
     switch (range) {
-        case ICM_ACCEL_16G: dev->accel_scale = 16.0f / 32768.0f; break;
-        case ICM_ACCEL_8G:  dev->accel_scale = 8.0f / 32768.0f; break;
-        case ICM_ACCEL_4G:  dev->accel_scale = 4.0f / 32768.0f; break;
-        case ICM_ACCEL_2G:  dev->accel_scale = 2.0f / 32768.0f; break;
+        case ICM_ACCEL_16G: dev->accel_scale = 16.0f / 32768.0f; dev->accel_fs_shift = 4; break;
+        case ICM_ACCEL_8G:  dev->accel_scale = 8.0f / 32768.0f;  dev->accel_fs_shift = 3; break;
+        case ICM_ACCEL_4G:  dev->accel_scale = 4.0f / 32768.0f;  dev->accel_fs_shift = 2; break;
+        case ICM_ACCEL_2G:  dev->accel_scale = 2.0f / 32768.0f;  dev->accel_fs_shift = 1; break;
         default: break;
     }
+    ICM_UpdateQ15Coef(dev);
     return 0;
 }
 
@@ -130,43 +390,427 @@ int8_t ICM42688_SetGyroConfig(ICM42688_t *dev, ICM_GyroRange_t range, ICM_ODR_t
     uint8_t config = (range << 5) | (odr & 0x0F);
     
     if (ICM_WriteReg(dev, ICM42688_GYRO_CONFIG0, config) != 0) return -1;
+    dev->gyro_config0 = config;
 
     // 更新换算系数
     switch (range) {
-        case ICM_GYRO_2000DPS: dev->gyro_scale = 2000.0f / 32768.0f; break;
-        case ICM_GYRO_1000DPS: dev->gyro_scale = 1000.0f / 32768.0f; break;
-        case ICM_GYRO_500DPS:  dev->gyro_scale = 500.0f / 32768.0f; break;
-        case ICM_GYRO_250DPS:  dev->gyro_scale = 250.0f / 32768.0f; break;
-        case ICM_GYRO_125DPS:  dev->gyro_scale = 125.0f / 32768.0f; break;
+        case ICM_GYRO_2000DPS: dev->gyro_scale = 2000.0f / 32768.0f; dev->gyro_fs_shift = 4; break;
+        case ICM_GYRO_1000DPS: dev->gyro_scale = 1000.0f / 32768.0f; dev->gyro_fs_shift = 3; break;
+        case ICM_GYRO_500DPS:  dev->gyro_scale = 500.0f / 32768.0f;  dev->gyro_fs_shift = 2; break;
+        case ICM_GYRO_250DPS:  dev->gyro_scale = 250.0f / 32768.0f;  dev->gyro_fs_shift = 1; break;
+        case ICM_GYRO_125DPS:  dev->gyro_scale = 125.0f / 32768.0f;  dev->gyro_fs_shift = 0; break;
         default: break;
     }
+    ICM_UpdateQ15Coef(dev);
     return 0;
 }
 
+// ODR 编码 -> 采样周期 (1/16 us), 0 表示保留编码
+static const uint32_t s_odr_period_x16[16] = {
+    0, 500, 1000, 2000, 4000, 8000, 16000, 80000,          // -, 32k, 16k, 8k, 4k, 2k, 1k, 200Hz
+    160000, 320000, 640000, 1280000,                        // 100, 50, 25, 12.5Hz
+    2560000, 5120000, 10240000, 32000                       // 6.25, 3.125, 1.5625, 500Hz
+};
+
+// FIFO 包按加速度计 / 陀螺仪中较快的 ODR 产生, 返回周期 (1/16 us)
+static uint32_t ICM_SamplePeriod(const ICM42688_t *dev) {
+    uint32_t pa = s_odr_period_x16[dev->accel_config0 & 0x0F];
+    uint32_t pg = s_odr_period_x16[dev->gyro_config0 & 0x0F];
+
+    if (pa == 0) return pg;
+    if (pg == 0) return pa;
+    return (pa < pg) ? pa : pg;
+}
+
 /**
- * @brief 读取传感器数据 (Burst Read)
+ * @brief 当前输出数据率 (Hz), 即 FIFO 包速率
  */
-int8_t ICM42688_ReadData(ICM42688_t *dev) {
+float ICM42688_GetSampleRate(const ICM42688_t *dev) {
+    uint32_t p = ICM_SamplePeriod(dev);
+    return (p > 0) ? 16000000.0f / (float)p : 0.0f;
+}
+
+/**
+ * @brief 选择外部时钟输入 (引脚 9 = CLKIN, 31 ~ 50kHz, 一般接 32.768kHz)
+ * @note  多片共用同一时钟时 ODR 完全同频, 相互之间没有漂移; 引脚 9 改作 CLKIN 后
+ *        不能再用作 INT2 / FSYNC. 应在开启传感器之前调用
+ */
+int8_t ICM42688_SetClockIn(ICM42688_t *dev, uint8_t enable) {
+    if (ICM_SetBank(dev, 1) != 0) return -1;
+    // INTF_CONFIG5.PIN9_FUNCTION[2:1]: 00=INT2, 10=CLKIN
+    int8_t ret = ICM_UpdateBits(dev, ICM42688_B1_INTF_CONFIG5, 0x06, enable ? 0x04 : 0x00);
+    if (ICM_SetBank(dev, 0) != 0 || ret != 0) return -1;
+
+    // INTF_CONFIG1.RTC_MODE(bit2): 使用 CLKIN 作为时钟源
+    return ICM_UpdateBits(dev, ICM42688_INTF_CONFIG1, 0x04, enable ? 0x04 : 0x00);
+}
+
+// ================= 片上滤波 =================
+
+// AAF 3dB 带宽 (Hz), 下标 = DELT - 1 (数据手册 5.3 节)
+static const uint16_t s_aaf_bw_hz[63] = {
+      42,   84,  126,  170,  213,  258,  303,  348,  394,  441,
+     488,  536,  585,  634,  684,  734,  785,  837,  890,  943,
+     997, 1051, 1107, 1163, 1220, 1277, 1336, 1395, 1454, 1515,
+    1577, 1639, 1702, 1766, 1830, 1896, 1962, 2029, 2097, 2166,
+    2235, 2306, 2377, 2449, 2522, 2596, 2671, 2746, 2823, 2900,
+    2978, 3057, 3137, 3217, 3299, 3381, 3464, 3548, 3633, 3718,
+    3805, 3892, 3979
+};
+
+// AAF_BITSHIFT 随 DELT 分段: {DELT 上限, BITSHIFT}
+static const uint8_t s_aaf_shift[][2] = {
+    {1, 15}, {2, 13}, {3, 12}, {4, 11}, {6, 10}, {9, 9},
+    {13, 8}, {18, 7}, {26, 6}, {36, 5}, {56, 4}, {63, 3}
+};
+
+/**
+ * @brief 按期望带宽查 AAF 参数
+ * @return 实际带宽 (Hz)
+ */
+uint16_t ICM42688_AAF_Lookup(uint16_t bw_hz, ICM_AAFConfig_t *cfg) {
+    uint8_t delt = 63;
+
+    for (uint8_t i = 0; i < 63; i++) {
+        if (s_aaf_bw_hz[i] >= bw_hz) {
+            delt = i + 1;
+            break;
+        }
+    }
+
+    cfg->delt = delt;
+    cfg->deltsqr = (uint16_t)delt * delt;
+    cfg->bw_hz = s_aaf_bw_hz[delt - 1];
+    for (uint8_t i = 0; i < sizeof(s_aaf_shift) / sizeof(s_aaf_shift[0]); i++) {
+        if (delt <= s_aaf_shift[i][0]) {
+            cfg->bitshift = s_aaf_shift[i][1];
+            break;
+        }
+    }
+    return cfg->bw_hz;
+}
+
+/**
+ * @brief 设置陀螺仪 UI 滤波器 (带宽 + 阶数)
+ */
+int8_t ICM42688_SetGyroUIFilter(ICM42688_t *dev, ICM_UIFiltBW_t bw, ICM_FiltOrder_t order) {
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    // GYRO_CONFIG1: GYRO_UI_FILT_ORD [3:2]
+    if (ICM_UpdateBits(dev, ICM42688_GYRO_CONFIG1, 0x0C, (uint8_t)(order << 2)) != 0) return -1;
+    // GYRO_ACCEL_CONFIG0: GYRO_UI_FILT_BW [3:0]
+    return ICM_UpdateBits(dev, ICM42688_GYRO_ACCEL_CONFIG0, 0x0F, (uint8_t)bw);
+}
+
+/**
+ * @brief 设置加速度计 UI 滤波器 (带宽 + 阶数)
+ */
+int8_t ICM42688_SetAccelUIFilter(ICM42688_t *dev, ICM_UIFiltBW_t bw, ICM_FiltOrder_t order) {
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    // ACCEL_CONFIG1: ACCEL_UI_FILT_ORD [4:3]
+    if (ICM_UpdateBits(dev, ICM42688_ACCEL_CONFIG1, 0x18, (uint8_t)(order << 3)) != 0) return -1;
+    // GYRO_ACCEL_CONFIG0: ACCEL_UI_FILT_BW [7:4]
+    return ICM_UpdateBits(dev, ICM42688_GYRO_ACCEL_CONFIG0, 0xF0, (uint8_t)(bw << 4));
+}
+
+/**
+ * @brief 设置陀螺仪抗混叠滤波器 (Bank 1)
+ */
+int8_t ICM42688_SetGyroAAF(ICM42688_t *dev, uint16_t bw_hz) {
+    ICM_AAFConfig_t cfg;
+    int8_t ret = -1;
+
+    if (ICM_SetBank(dev, 1) != 0) return -1;
+
+    if (bw_hz == 0) {
+        ret = ICM_UpdateBits(dev, ICM42688_B1_GYRO_STATIC2, 0x02, 0x02); // GYRO_AAF_DIS
+    } else {
+        ICM42688_AAF_Lookup(bw_hz, &cfg);
+        if (ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC3, cfg.delt) == 0 &&
+            ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC4, cfg.deltsqr & 0xFF) == 0 &&
+            ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC5, (uint8_t)((cfg.bitshift << 4) | (cfg.deltsqr >> 8))) == 0) {
+            ret = ICM_UpdateBits(dev, ICM42688_B1_GYRO_STATIC2, 0x02, 0x00);
+        }
+    }
+
+    ICM_SetBank(dev, 0);
+    return ret;
+}
+
+/**
+ * @brief 设置加速度计抗混叠滤波器 (Bank 2)
+ */
+int8_t ICM42688_SetAccelAAF(ICM42688_t *dev, uint16_t bw_hz) {
+    ICM_AAFConfig_t cfg;
+    int8_t ret = -1;
+
+    if (ICM_SetBank(dev, 2) != 0) return -1;
+
+    if (bw_hz == 0) {
+        ret = ICM_UpdateBits(dev, ICM42688_B2_ACCEL_STATIC2, 0x01, 0x01); // ACCEL_AAF_DIS
+    } else {
+        ICM42688_AAF_Lookup(bw_hz, &cfg);
+        // DELT 与 DIS 位在同一寄存器, 一次写入同时使能
+        if (ICM_WriteReg(dev, ICM42688_B2_ACCEL_STATIC2, (uint8_t)(cfg.delt << 1)) == 0 &&
+            ICM_WriteReg(dev, ICM42688_B2_ACCEL_STATIC3, cfg.deltsqr & 0xFF) == 0) {
+            ret = ICM_WriteReg(dev, ICM42688_B2_ACCEL_STATIC4, (uint8_t)((cfg.bitshift << 4) | (cfg.deltsqr >> 8)));
+        }
+    }
+
+    ICM_SetBank(dev, 0);
+    return ret;
+}
+
+/**
+ * @brief 设置陀螺仪陷波器 (Bank 1)
+ * @note  COSWZ = cos(2*pi*f/32kHz); |COSWZ| <= 0.875 时直接取 COSWZ*256,
+ *        否则 SEL=1, 取 8*(1-|COSWZ|)*256 (负值保留符号), 均为 9 位补码
+ */
+int8_t ICM42688_SetGyroNotch(ICM42688_t *dev, const float freq_hz[3], ICM_NotchBW_t bw) {
+    uint8_t lo[3];
+    uint8_t sel_hi = 0;
+    int8_t ret = -1;
+
+    if (ICM_SetBank(dev, 1) != 0) return -1;
+
+    if (freq_hz == NULL) {
+        ret = ICM_UpdateBits(dev, ICM42688_B1_GYRO_STATIC2, 0x01, 0x01); // GYRO_NF_DIS
+        ICM_SetBank(dev, 0);
+        return ret;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        float c = cosf(2.0f * 3.14159265f * freq_hz[i] / 32000.0f);
+        int16_t v;
+
+        if (c > 0.875f) {
+            v = (int16_t)lroundf(8.0f * (1.0f - c) * 256.0f);
+            sel_hi |= 0x08 << i;
+        } else if (c < -0.875f) {
+            v = (int16_t)lroundf(-8.0f * (1.0f + c) * 256.0f);
+            sel_hi |= 0x08 << i;
+        } else {
+            v = (int16_t)lroundf(c * 256.0f);
+        }
+        lo[i] = (uint8_t)(v & 0xFF);
+        if (v & 0x100) sel_hi |= 0x01 << i; // 补码第 8 位
+    }
+
+    if (ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC6, lo[0]) == 0 &&
+        ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC6 + 1, lo[1]) == 0 &&
+        ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC6 + 2, lo[2]) == 0 &&
+        ICM_WriteReg(dev, ICM42688_B1_GYRO_STATIC9, sel_hi) == 0 &&
+        ICM_UpdateBits(dev, ICM42688_B1_GYRO_STATIC10, 0x70, (uint8_t)(bw << 4)) == 0) {
+        ret = ICM_UpdateBits(dev, ICM42688_B1_GYRO_STATIC2, 0x01, 0x00);
+    }
+
     ICM_SetBank(dev, 0);
-    uint8_t buffer[14]; // Temp(2) + Accel(6) + Gyro(6)
+    return ret;
+}
+
+// ================= APEX 运动引擎 =================
+
+// DMP 频率对应的加速度计 ODR
+static uint8_t ICM_APEX_AccelODR(ICM_DmpODR_t odr) {
+    switch (odr) {
+        case ICM_DMP_ODR_25HZ:  return ICM_ODR_25Hz;
+        case ICM_DMP_ODR_100HZ: return ICM_ODR_100Hz;
+        case ICM_DMP_ODR_500HZ: return ICM_ODR_500Hz;
+        default:                return ICM_ODR_50Hz;
+    }
+}
+
+// 加速度计低功耗模式 (保留量程), 陀螺仪关闭
+static int8_t ICM_APEX_EnterLP(ICM42688_t *dev) {
+    uint8_t cfg = (dev->accel_config0 & 0xF0) | ICM_APEX_AccelODR(dev->apex_odr);
+
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    if (ICM_WriteReg(dev, ICM42688_ACCEL_CONFIG0, cfg) != 0) return -1;
+    // PWR_MGMT0: GYRO_MODE = 00 (关), ACCEL_MODE = 10 (LP)
+    if (ICM_WriteReg(dev, ICM42688_PWR_MGMT0, 0x02) != 0) return -1;
+    HAL_Delay(1);
+    return 0;
+}
+
+// 中断引脚设为推挽、高有效、锁存 (读状态寄存器后释放), 不影响另一个引脚
+static int8_t ICM_APEX_ConfigPin(ICM42688_t *dev, ICM_IntPin_t pin) {
+    if (pin == ICM_INT1) {
+        if (ICM_UpdateBits(dev, ICM42688_INT_CONFIG, 0x07, 0x07) != 0) return -1;
+    } else {
+        if (ICM_UpdateBits(dev, ICM42688_INT_CONFIG, 0x38, 0x38) != 0) return -1;
+    }
+    // INT_CONFIG1: INT_ASYNC_RESET(bit4) 必须清 0
+    return ICM_UpdateBits(dev, ICM42688_INT_CONFIG1, 0x10, 0x00);
+}
+
+/**
+ * @brief 设置 DMP 运行频率 (下次 APEX_Start/StartWOM 时生效)
+ */
+int8_t ICM42688_APEX_SetDmpODR(ICM42688_t *dev, ICM_DmpODR_t odr) {
+    if (dev->apex_features != 0 || dev->apex_wom) return -1; // 运行中不能改
+    dev->apex_odr = odr;
+    return 0;
+}
+
+/**
+ * @brief 开启运动唤醒 (可选显著运动检测)
+ * @param thr_mg 三轴相对上一采样的变化阈值 (mg), 最大 996mg
+ * @note  按数据手册 WOM 初始化顺序: LP 模式 -> 阈值 -> 中断 -> 等待 50ms -> SMD_CONFIG
+ */
+int8_t ICM42688_APEX_StartWOM(ICM42688_t *dev, uint16_t thr_mg, ICM_SmdMode_t mode, ICM_IntPin_t pin) {
+    uint32_t thr = ((uint32_t)thr_mg * 256 + 500) / 1000;
+    if (thr > 255) thr = 255;
+    if (thr == 0) thr = 1;
+
+    if (ICM_APEX_EnterLP(dev) != 0) return -1;
+
+    if (ICM_SetBank(dev, 4) != 0) return -1;
+    for (uint8_t i = 0; i < 3; i++) {
+        if (ICM_WriteReg(dev, ICM42688_B4_WOM_X_THR + i, (uint8_t)thr) != 0) {
+            ICM_SetBank(dev, 0);
+            return -1;
+        }
+    }
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    HAL_Delay(1);
+
+    if (ICM_APEX_ConfigPin(dev, pin) != 0) return -1;
+    // INT_SOURCE1/4: SMD(bit3) + WOM X/Y/Z(bit2:0)
+    uint8_t src = (mode == ICM_SMD_WOM_ONLY) ? 0x07 : 0x08;
+    if (ICM_WriteReg(dev, (pin == ICM_INT1) ? ICM42688_INT_SOURCE1 : ICM42688_INT_SOURCE4, src) != 0) return -1;
+    HAL_Delay(50);
+
+    // SMD_CONFIG: WOM_INT_MODE(bit3)=0 任一轴触发, WOM_MODE(bit2)=1 与上一采样比较
+    if (ICM_WriteReg(dev, ICM42688_SMD_CONFIG, 0x04 | mode) != 0) return -1;
+
+    dev->apex_wom = 1;
+    return 0;
+}
+
+/**
+ * @brief 开启 DMP 功能 (计步 / 倾斜检测, 可组合)
+ * @param features ICM_APEX_PEDOMETER | ICM_APEX_TILT
+ * @note  按数据手册 APEX 初始化顺序: LP 模式 + DMP ODR -> 复位 DMP 内存 -> 中断 -> 等待 50ms -> DMP 初始化 -> 使能
+ */
+int8_t ICM42688_APEX_Start(ICM42688_t *dev, uint8_t features, ICM_IntPin_t pin) {
+    features &= (ICM_APEX_PEDOMETER | ICM_APEX_TILT);
+    if (features == 0) return -1;
+
+    if (ICM_APEX_EnterLP(dev) != 0) return -1;
+
+    // APEX_CONFIG0: DMP_POWER_SAVE(bit7)=1, 功能先全部关闭, DMP_ODR
+    if (ICM_WriteReg(dev, ICM42688_APEX_CONFIG0, 0x80 | dev->apex_odr) != 0) return -1;
+    // SIGNAL_PATH_RESET: DMP_MEM_RESET_EN(bit5)
+    if (ICM_WriteReg(dev, ICM42688_SIGNAL_PATH_RESET, 0x20) != 0) return -1;
+    HAL_Delay(1);
+
+    if (ICM_APEX_ConfigPin(dev, pin) != 0) return -1;
+
+    // INT_SOURCE6/7: STEP_DET(bit5), STEP_CNT_OFL(bit4), TILT_DET(bit3)
+    uint8_t src = 0;
+    if (features & ICM_APEX_PEDOMETER) src |= 0x30;
+    if (features & ICM_APEX_TILT) src |= 0x08;
+    if (ICM_SetBank(dev, 4) != 0) return -1;
+    int8_t ret = ICM_WriteReg(dev, (pin == ICM_INT1) ? ICM42688_B4_INT_SOURCE6 : ICM42688_B4_INT_SOURCE7, src);
+    ICM_SetBank(dev, 0);
+    if (ret != 0) return -1;
+    HAL_Delay(50);
+
+    // SIGNAL_PATH_RESET: DMP_INIT_EN(bit6)
+    if (ICM_WriteReg(dev, ICM42688_SIGNAL_PATH_RESET, 0x40) != 0) return -1;
+    HAL_Delay(1);
+
+    if (ICM_WriteReg(dev, ICM42688_APEX_CONFIG0, 0x80 | features | dev->apex_odr) != 0) return -1;
+
+    dev->apex_features = features;
+    return 0;
+}
+
+/**
+ * @brief 关闭全部 APEX 功能, 恢复低噪声模式与原 ODR
+ */
+int8_t ICM42688_APEX_Stop(ICM42688_t *dev) {
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+
+    if (ICM_WriteReg(dev, ICM42688_APEX_CONFIG0, 0x80 | dev->apex_odr) != 0) return -1;
+    if (ICM_WriteReg(dev, ICM42688_SMD_CONFIG, 0x00) != 0) return -1;
+    // INT_SOURCE1/4 中只清 SMD/WOM 位, 保留其它来源
+    if (ICM_UpdateBits(dev, ICM42688_INT_SOURCE1, 0x0F, 0x00) != 0) return -1;
+    if (ICM_UpdateBits(dev, ICM42688_INT_SOURCE4, 0x0F, 0x00) != 0) return -1;
+
+    if (ICM_SetBank(dev, 4) != 0) return -1;
+    int8_t ret = ICM_WriteReg(dev, ICM42688_B4_INT_SOURCE6, 0x00);
+    if (ret == 0) ret = ICM_WriteReg(dev, ICM42688_B4_INT_SOURCE7, 0x00);
+    ICM_SetBank(dev, 0);
+    if (ret != 0) return -1;
+
+    dev->apex_features = 0;
+    dev->apex_wom = 0;
+
+    if (ICM_WriteReg(dev, ICM42688_ACCEL_CONFIG0, dev->accel_config0) != 0) return -1;
+    if (ICM_WriteReg(dev, ICM42688_GYRO_CONFIG0, dev->gyro_config0) != 0) return -1;
+    if (ICM_WriteReg(dev, ICM42688_PWR_MGMT0, 0x0F) != 0) return -1; // Gyro LN | Accel LN
+    HAL_Delay(45);
+    return 0;
+}
+
+/**
+ * @brief 读取并清除 APEX 事件 (INT_STATUS2/3, 读后清零, 同时释放锁存的 INTx)
+ */
+int8_t ICM42688_APEX_GetEvents(ICM42688_t *dev, uint16_t *events) {
+    uint8_t st[2];
+
+    *events = 0;
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    if (ICM_ReadRegs(dev, ICM42688_INT_STATUS2, st, 2) != 0) return -1;
+
+    *events = (uint16_t)((st[0] & 0x0F) | ((st[1] & 0x3F) << 8));
+    return 0;
+}
+
+/**
+ * @brief 读取计步结果
+ * @param cadence 步频 (u6.2 格式: 两步之间的 DMP 采样数 x 4), 可为 NULL
+ * @param activity 可为 NULL
+ */
+int8_t ICM42688_APEX_GetSteps(ICM42688_t *dev, uint16_t *steps, uint8_t *cadence, uint8_t *activity) {
+    uint8_t d[4];
+
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    if (ICM_ReadRegs(dev, ICM42688_APEX_DATA0, d, 4) != 0) return -1;
+
+    *steps = (uint16_t)(d[0] | (d[1] << 8));
+    if (cadence != NULL) *cadence = d[2];
+    if (activity != NULL) *activity = d[3] & 0x03;
+    return 0;
+}
+
+/**
+ * @brief 只读取原始数据 (Burst Read), 结果在 dev->raw_data
+ */
+int8_t ICM42688_ReadRaw(ICM42688_t *dev) {
+    // Bank 已缓存, 通常不产生 SPI 事务
+    if (ICM_SetBank(dev, 0) != 0) return -1;
     
-    // 从 TEMP_DATA1 (0x1D) 开始读取 14 个字节
+    // 从 TEMP_DATA1 (0x1D) 开始读取 14 个字节: Temp(2) + Accel(6) + Gyro(6)
     // 顺序: TempH, TempL, AccelX_H, AccelX_L ... GyroZ_L
-    if (ICM_ReadRegs(dev, ICM42688_TEMP_DATA1, buffer, 14) != 0) return -1;
+    if (ICM_ReadFrame(dev, ICM42688_TEMP_DATA1, dev->frame, 14) != 0) return -1;
 
-    // 1. 解析原始数据 (Big Endian)
-    dev->raw_data.temp_raw    = (int16_t)((buffer[0] << 8) | buffer[1]);
-    dev->raw_data.accel_x_raw = (int16_t)((buffer[2] << 8) | buffer[3]);
-    dev->raw_data.accel_y_raw = (int16_t)((buffer[4] << 8) | buffer[5]);
-    dev->raw_data.accel_z_raw = (int16_t)((buffer[6] << 8) | buffer[7]);
-    dev->raw_data.gyro_x_raw  = (int16_t)((buffer[8] << 8) | buffer[9]);
-    dev->raw_data.gyro_y_raw  = (int16_t)((buffer[10] << 8) | buffer[11]);
-    dev->raw_data.gyro_z_raw  = (int16_t)((buffer[12] << 8) | buffer[13]);
+    // 解析原始数据 (Big Endian)
+    ICM_ParseRegs(&dev->frame[1], &dev->raw_data);
+    return 0;
+}
+
+/**
+ * @brief 读取传感器数据并换算为浮点物理量
+ */
+int8_t ICM42688_ReadData(ICM42688_t *dev) {
+    // 1. 读取原始数据
+    if (ICM42688_ReadRaw(dev) != 0) return -1;
 
     // 2. 转换为物理量
-    dev->data.accel_x_g = dev->raw_data.accel_x_raw * dev->accel_scale;
-    dev->data.accel_y_g = dev->raw_data.accel_y_raw * dev->accel_scale;
-    dev->data.accel_z_g = dev->raw_data.accel_z_raw * dev->accel_scale;
+    dev->data.accel_x_g = dev->raw_data.accel_x_raw * dev->accel_scale * dev->accel_gain[0];
+    dev->data.accel_y_g = dev->raw_data.accel_y_raw * dev->accel_scale * dev->accel_gain[1];
+    dev->data.accel_z_g = dev->raw_data.accel_z_raw * dev->accel_scale * dev->accel_gain[2];
 
     dev->data.gyro_x_dps = dev->raw_data.gyro_x_raw * dev->gyro_scale;
     dev->data.gyro_y_dps = dev->raw_data.gyro_y_raw * dev->gyro_scale;
@@ -177,3 +821,742 @@ int8_t ICM42688_ReadData(ICM42688_t *dev) {
 
     return 0;
 }
+
+/**
+ * @brief 原始数据换算为 Q16.16 定点物理量 (只用移位和整数乘法, 不含比例校准)
+ * @note  加速度 1 LSB = 2^(shift+1-16) g, 即 Q16.16 下左移 (shift+1);
+ *        角速度 1 LSB = 125 * 2^shift / 32768 dps, 即 Q16.16 下乘 250 << shift;
+ *        温度 65536 / 132.48 = 494.69 = 31660 / 64
+ */
+void ICM42688_ConvertFixed(const ICM42688_t *dev, const ICM_RawData_t *raw, ICM_FixedData_t *out) {
+    uint8_t as = dev->accel_fs_shift + 1;
+    int32_t gk = 250 << dev->gyro_fs_shift;
+
+    out->accel_x_g = (int32_t)raw->accel_x_raw * (1 << as);
+    out->accel_y_g = (int32_t)raw->accel_y_raw * (1 << as);
+    out->accel_z_g = (int32_t)raw->accel_z_raw * (1 << as);
+
+    out->gyro_x_dps = raw->gyro_x_raw * gk;
+    out->gyro_y_dps = raw->gyro_y_raw * gk;
+    out->gyro_z_dps = raw->gyro_z_raw * gk;
+
+    out->temp_c = (((int32_t)raw->temp_raw * 31660) >> 6) + (25 << 16);
+}
+
+/**
+ * @brief 设置 Q15 换算的增益/偏移, cal 为 NULL 时恢复默认
+ */
+void ICM42688_SetQ15Cal(ICM42688_t *dev, const ICM_Q15Cal_t *cal) {
+    if (cal != NULL) {
+        dev->q15_cal = *cal;
+    } else {
+        for (uint8_t i = 0; i < 6; i++) {
+            dev->q15_cal.gain_q15[i] = 32767;
+            dev->q15_cal.offset[i] = 0;
+        }
+    }
+    ICM_UpdateQ15Coef(dev);
+}
+
+/**
+ * @brief 写入芯片用户偏移 (Bank 4 OFFSET_USER0 ~ 8)
+ * @note  芯片在输出前加上该值, 对数据寄存器与 FIFO 都生效; 写入前已在 FIFO 中的数据不受影响
+ */
+int8_t ICM42688_SetUserOffset(ICM42688_t *dev, const int16_t offset[6]) {
+    uint16_t v[6];
+    uint8_t reg[9];
+
+    for (uint8_t i = 0; i < 6; i++) {
+        int16_t o = offset[i];
+        if (o > 2047) o = 2047;
+        if (o < -2047) o = -2047;
+        dev->offset_user[i] = o;
+        v[i] = (uint16_t)o & 0x0FFF;
+    }
+
+    // 寄存器排列: Gyro X/Y/Z 在前, Accel X/Y/Z 在后, 相邻两轴共用一个字节存放高 4 位
+    reg[0] = v[3] & 0xFF;
+    reg[1] = (uint8_t)(((v[4] >> 8) << 4) | (v[3] >> 8));
+    reg[2] = v[4] & 0xFF;
+    reg[3] = v[5] & 0xFF;
+    reg[4] = (uint8_t)(((v[0] >> 8) << 4) | (v[5] >> 8));
+    reg[5] = v[0] & 0xFF;
+    reg[6] = v[1] & 0xFF;
+    reg[7] = (uint8_t)(((v[2] >> 8) << 4) | (v[1] >> 8));
+    reg[8] = v[2] & 0xFF;
+
+    if (ICM_SetBank(dev, 4) != 0) return -1;
+    for (uint8_t i = 0; i < 9; i++) {
+        if (ICM_WriteReg(dev, ICM42688_B4_OFFSET_USER0 + i, reg[i]) != 0) {
+            ICM_SetBank(dev, 0);
+            return -1;
+        }
+    }
+    return ICM_SetBank(dev, 0);
+}
+
+/**
+ * @brief 设置加速度计比例校准, 同时更新 Q15 系数
+ * @return 0 成功, -1 增益不在 (0, 2.0) 内 (Q15 路径无法表示, 不做修改)
+ */
+int8_t ICM42688_SetAccelGain(ICM42688_t *dev, const float gain[3]) {
+    if (gain != NULL) {
+        for (uint8_t i = 0; i < 3; i++) {
+            if (!(gain[i] > 0.0f && gain[i] < 2.0f)) return -1;
+        }
+    }
+    for (uint8_t i = 0; i < 3; i++) dev->accel_gain[i] = (gain != NULL) ? gain[i] : 1.0f;
+    ICM_UpdateQ15Coef(dev);
+    return 0;
+}
+
+/**
+ * @brief 批量换算为 Q15 (量程归一到 16g / 2000dps, 同时应用校准)
+ * @note  DSP 下每轴一条 SMLAD + SSAT, 不使用 FPU
+ */
+void ICM42688_ConvertBatchQ15(const ICM42688_t *dev, const ICM_RawData_t *in, ICM_Q15Data_t *out, uint16_t n) {
+    const uint32_t *c = dev->q15_coef;
+    uint8_t ash = dev->q15_accel_shift;
+
+    for (uint16_t i = 0; i < n; i++) {
+        const ICM_RawData_t *r = &in[i];
+#if ICM_Q15_USE_DSP
+        out[i].accel[0] = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->accel_x_raw), c[0], ash);
+        out[i].accel[1] = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->accel_y_raw), c[1], ash);
+        out[i].accel[2] = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->accel_z_raw), c[2], ash);
+        out[i].gyro[0]  = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->gyro_x_raw), c[3], 15);
+        out[i].gyro[1]  = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->gyro_y_raw), c[4], 15);
+        out[i].gyro[2]  = ICM_Q15Apply(ICM_Q15_LO((uint16_t)r->gyro_z_raw), c[5], 15);
+#else
+        out[i].accel[0] = ICM_Q15Apply(r->accel_x_raw, c[0], ash);
+        out[i].accel[1] = ICM_Q15Apply(r->accel_y_raw, c[1], ash);
+        out[i].accel[2] = ICM_Q15Apply(r->accel_z_raw, c[2], ash);
+        out[i].gyro[0]  = ICM_Q15Apply(r->gyro_x_raw, c[3], 15);
+        out[i].gyro[1]  = ICM_Q15Apply(r->gyro_y_raw, c[4], 15);
+        out[i].gyro[2]  = ICM_Q15Apply(r->gyro_z_raw, c[5], 15);
+#endif
+    }
+}
+
+/**
+ * @brief 配置 FIFO
+ * @param mode      FIFO 模式, ICM_FIFO_BYPASS 为关闭
+ * @param watermark 水位 (单位: 包), 0 表示不使用水位中断
+ * @note  FIFO 计数与水位都以 "包" 为单位 (INTF_CONFIG0.FIFO_COUNT_REC = 1)
+ */
+int8_t ICM42688_FIFO_Config(ICM42688_t *dev, ICM_FifoMode_t mode, uint16_t watermark) {
+    ICM_SetBank(dev, 0);
+
+    // 先切到 Bypass, 修改配置期间 FIFO 不写入
+    if (ICM_WriteReg(dev, ICM42688_FIFO_CONFIG, ICM_FIFO_BYPASS) != 0) return -1;
+
+    // INTF_CONFIG0: FIFO_COUNT_REC(bit6)=1 按包计数, 计数和数据保持大端 (bit5/bit4 = 1)
+    if (ICM_WriteReg(dev, ICM42688_INTF_CONFIG0, 0x70) != 0) return -1;
+
+    // FIFO_CONFIG1: WM_GT_TH(bit5) 计数 >= 水位即触发, HIRES_EN(bit4) 20 位包,
+    // TMST_FSYNC(bit3) 包内带时间戳, TEMP/GYRO/ACCEL 入 FIFO -> 包 3 (或包 4)
+    if (ICM_WriteReg(dev, ICM42688_FIFO_CONFIG1, dev->fifo_hires ? 0x3F : 0x2F) != 0) return -1;
+    // TMST_CONFIG: 1us 分辨率的绝对时间戳 (见 ICM42688_TS_Enable)
+    if (ICM_WriteReg(dev, ICM42688_TMST_CONFIG, 0x31) != 0) return -1;
+
+    if (ICM_WriteReg(dev, ICM42688_FIFO_CONFIG2, watermark & 0xFF) != 0) return -1;
+    if (ICM_WriteReg(dev, ICM42688_FIFO_CONFIG3, (watermark >> 8) & 0x0F) != 0) return -1;
+
+    if (ICM_WriteReg(dev, ICM42688_FIFO_CONFIG, mode) != 0) return -1;
+
+    dev->fifo_mode = mode;
+    dev->fifo_pkt_len = dev->fifo_hires ? ICM_FIFO_PKT4_LEN : ICM_FIFO_PKT3_LEN;
+
+    return ICM42688_FIFO_Flush(dev);
+}
+
+/**
+ * @brief 选择 20 位高精度包 (包 4) 或 16 位包 (包 3)
+ * @note  FIFO 已开启时按当前模式重新配置 (水位清零) 并清空
+ */
+int8_t ICM42688_FIFO_SetHiRes(ICM42688_t *dev, uint8_t enable) {
+    if (dev->it_mode != ICM_IT_NONE) return -1; // 中断采集按包 3 解析
+
+    dev->fifo_hires = enable ? 1 : 0;
+    if (dev->fifo_mode == ICM_FIFO_BYPASS) {
+        dev->fifo_pkt_len = dev->fifo_hires ? ICM_FIFO_PKT4_LEN : ICM_FIFO_PKT3_LEN;
+        return 0;
+    }
+    return ICM42688_FIFO_Config(dev, dev->fifo_mode, 0);
+}
+
+/**
+ * @brief 清空 FIFO
+ */
+int8_t ICM42688_FIFO_Flush(ICM42688_t *dev) {
+    // SIGNAL_PATH_RESET: FIFO_FLUSH(bit1), 自动清零
+    return ICM_WriteReg(dev, ICM42688_SIGNAL_PATH_RESET, 0x02);
+}
+
+/**
+ * @brief 读取 FIFO 中的包数
+ */
+int8_t ICM42688_FIFO_GetCount(ICM42688_t *dev, uint16_t *count) {
+    uint8_t buf[2];
+    if (ICM_ReadRegs(dev, ICM42688_FIFO_COUNTH, buf, 2) != 0) return -1;
+    *count = (uint16_t)((buf[0] << 8) | buf[1]);
+    return 0;
+}
+
+/**
+ * @brief 一次 SPI 事务突发读取多个 FIFO 包
+ * @param out 输出数组
+ * @param max 数组容量 (包), 超过 ICM_FIFO_BURST_MAX 的部分留给下次读取
+ * @param got 实际解析出的包数
+ */
+int8_t ICM42688_FIFO_Read(ICM42688_t *dev, ICM_RawData_t *out, uint16_t max, uint16_t *got) {
+    uint16_t count = 0;
+
+    *got = 0;
+    if (dev->fifo_hires) return -1; // 用 ICM42688_FIFO_ReadHiRes
+    if (ICM42688_FIFO_GetCount(dev, &count) != 0) return -1;
+
+    if (count > max) count = max;
+    if (count > ICM_FIFO_BURST_MAX) count = ICM_FIFO_BURST_MAX;
+    if (count == 0) return 0;
+
+    if (ICM_ReadFrame(dev, ICM42688_FIFO_DATA, s_fifo_buf, count * ICM_FIFO_PKT3_LEN) != 0) return -1;
+
+    *got = ICM_ParseFifo(&s_fifo_buf[1], count, out);
+    ICM_TS_ExtendSamples(dev, out, *got);
+    return 0;
+}
+
+/**
+ * @brief 一次 SPI 事务突发读取多个 20 位高精度包
+ * @param max 数组容量 (包), 超过 ICM_FIFO_BURST_MAX 的部分留给下次读取
+ */
+int8_t ICM42688_FIFO_ReadHiRes(ICM42688_t *dev, ICM_HiResData_t *out, uint16_t max, uint16_t *got) {
+    uint16_t count = 0;
+
+    *got = 0;
+    if (!dev->fifo_hires) return -1;
+    if (ICM42688_FIFO_GetCount(dev, &count) != 0) return -1;
+
+    if (count > max) count = max;
+    if (count > ICM_FIFO_BURST_MAX) count = ICM_FIFO_BURST_MAX;
+    if (count == 0) return 0;
+
+    if (ICM_ReadFrame(dev, ICM42688_FIFO_DATA, s_fifo_buf, count * ICM_FIFO_PKT4_LEN) != 0) return -1;
+
+    *got = ICM_ParseFifoHiRes(&s_fifo_buf[1], count, out);
+    for (uint16_t i = 0; i < *got; i++) {
+        out[i].timestamp = ICM_TS_Extend(dev, (uint16_t)out[i].timestamp);
+    }
+    return 0;
+}
+
+/**
+ * @brief 高精度数据换算为浮点物理量 (固定 8192 LSB/g, 131 LSB/dps)
+ */
+void ICM42688_ConvertHiRes(const ICM_HiResData_t *in, ICM_PhysData_t *out) {
+    const float ak = 1.0f / ICM_HIRES_ACCEL_LSB_PER_G;
+    const float gk = 1.0f / ICM_HIRES_GYRO_LSB_PER_DPS;
+
+    out->accel_x_g = in->accel_x * ak;
+    out->accel_y_g = in->accel_y * ak;
+    out->accel_z_g = in->accel_z * ak;
+
+    out->gyro_x_dps = in->gyro_x * gk;
+    out->gyro_y_dps = in->gyro_y * gk;
+    out->gyro_z_dps = in->gyro_z * gk;
+
+    out->temp_c = (in->temp_raw / 132.48f) + 25.0f;
+}
+
+/**
+ * @brief 突发读取 FIFO 并直接换算为 Q15, 省去中间的 ICM_RawData_t
+ */
+int8_t ICM42688_FIFO_ReadQ15(ICM42688_t *dev, ICM_Q15Data_t *out, uint16_t max, uint16_t *got) {
+    uint16_t count = 0;
+    uint16_t n = 0;
+
+    *got = 0;
+    if (dev->fifo_hires) return -1;
+    if (ICM42688_FIFO_GetCount(dev, &count) != 0) return -1;
+
+    if (count > max) count = max;
+    if (count > ICM_FIFO_BURST_MAX) count = ICM_FIFO_BURST_MAX;
+    if (count == 0) return 0;
+
+    if (ICM_ReadFrame(dev, ICM42688_FIFO_DATA, s_fifo_buf, count * ICM_FIFO_PKT3_LEN) != 0) return -1;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t *p = &s_fifo_buf[1 + i * ICM_FIFO_PKT3_LEN];
+
+        if (p[0] & ICM_FIFO_HEADER_MSG) break; // FIFO 已空
+        if ((p[0] & (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO)) !=
+            (ICM_FIFO_HEADER_ACCEL | ICM_FIFO_HEADER_GYRO)) continue;
+
+        ICM_Q15FromPacket(p, dev->q15_coef, dev->q15_accel_shift, &out[n++]);
+    }
+    *got = n;
+    return 0;
+}
+
+// ================= 时间戳 =================
+
+/**
+ * @brief 开启芯片时间戳 (1us, 绝对值), 使能 DWT 时基, 并复位时间关联
+ */
+int8_t ICM42688_TS_Enable(ICM42688_t *dev) {
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+
+    // TMST_CONFIG: bit5 保留 (默认 1), TMST_TO_REGS_EN(bit4)=1 允许锁存到 TMSTVAL,
+    // TMST_RES(bit3)=0 1us, TMST_DELTA_EN(bit2)=0 绝对值, TMST_FSYNC_EN(bit1)=0, TMST_EN(bit0)=1
+    if (ICM_WriteReg(dev, ICM42688_TMST_CONFIG, 0x31) != 0) return -1;
+
+    // 默认 ICM_TS_NOW 使用 DWT 周期计数器
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    ICM42688_TS_Reset(dev);
+    return 0;
+}
+
+/**
+ * @brief 复位时间关联 (丢弃展开状态、参考点与偏差估计)
+ */
+void ICM42688_TS_Reset(ICM42688_t *dev) {
+    memset(&dev->ts, 0, sizeof(ICM_TimeSync_t));
+    dev->ts.rate_nominal = (float)ICM_TS_NOW_HZ / 1000000.0f;
+    dev->ts.rate = dev->ts.rate_nominal;
+}
+
+/**
+ * @brief 锁存芯片当前时间并与 MCU 时间配对 (轮询方式的同步点)
+ * @note  阻塞 SPI, 不能与中断采集同时使用; 应紧跟在 FIFO 读取之后调用
+ */
+int8_t ICM42688_TS_Strobe(ICM42688_t *dev) {
+    uint8_t v[3];
+
+    if (ICM_SetBank(dev, 0) != 0) return -1;
+    // SIGNAL_PATH_RESET.TMST_STROBE(bit2): 写入瞬间锁存计数器
+    if (ICM_WriteReg(dev, ICM42688_SIGNAL_PATH_RESET, 0x04) != 0) return -1;
+    uint32_t now = ICM_TS_NOW();
+
+    if (ICM_SetBank(dev, 1) != 0) return -1;
+    int8_t ret = ICM_ReadRegs(dev, ICM42688_B1_TMSTVAL0, v, 3);
+    ICM_SetBank(dev, 0);
+    if (ret != 0) return -1;
+
+    // 20 位锁存值, 只取低 16 位与 FIFO 时间戳走同一条展开链
+    ICM42688_TS_AddPair(dev, ICM_TS_Extend(dev, (uint16_t)(v[0] | (v[1] << 8))), now);
+    return 0;
+}
+
+/**
+ * @brief 加入一个同步点 (芯片时间, 同一时刻的 MCU 时间)
+ * @note  二阶环路: 参考点按残差的一部分修正, rate 按残差 / 间隔积分, 得到时钟偏差
+ */
+void ICM42688_TS_AddPair(ICM42688_t *dev, uint32_t imu_us, uint32_t mcu_now) {
+    ICM_TimeSync_t *ts = &dev->ts;
+
+    if (ts->pairs == 0) {
+        ts->imu_ref = imu_us;
+        ts->mcu_ref = mcu_now;
+        ts->pairs = 1;
+        return;
+    }
+
+    int32_t d_imu = (int32_t)(imu_us - ts->imu_ref);
+    if (d_imu < (int32_t)ICM_TS_MIN_SPAN_US) return;
+
+    // 间隔超过 MCU 计数的有符号范围 (DWT@168MHz 约 12s) 则重新锁定
+    if ((float)d_imu * ts->rate_nominal > 2.0e9f) {
+        ts->pairs = 0;
+        ICM42688_TS_AddPair(dev, imu_us, mcu_now);
+        return;
+    }
+
+    int32_t d_mcu = (int32_t)(mcu_now - ts->mcu_ref);
+    int32_t pred = (int32_t)((float)d_imu * ts->rate);
+    int32_t err = d_mcu - pred;
+
+    if (ts->pairs == 1) {
+        // 第一段直接测量
+        ts->rate = (float)d_mcu / (float)d_imu;
+        ts->mcu_ref = mcu_now;
+    } else {
+        int32_t lim = (int32_t)(ICM_TS_REJECT_US * ts->rate_nominal);
+        if (err > lim || err < -lim) {
+            ts->rejected++;
+            if (++ts->reject_run >= 4) ts->pairs = 0; // 连续异常: 多半是时钟跳变, 重新锁定
+            return;
+        }
+        ts->reject_run = 0;
+        if (err > ts->jitter_max) ts->jitter_max = err;
+        if (-err > ts->jitter_max) ts->jitter_max = -err;
+
+        ts->rate += ICM_TS_K_RATE * (float)err / (float)d_imu;
+        ts->mcu_ref += (uint32_t)(pred + (int32_t)(ICM_TS_K_PHASE * (float)err));
+    }
+    ts->imu_ref = imu_us;
+    ts->pairs++;
+    ts->drift_ppm = (ts->rate / ts->rate_nominal - 1.0f) * 1.0e6f;
+}
+
+/**
+ * @brief 芯片时间换算为 MCU 时间
+ */
+uint32_t ICM42688_TS_ToMcu(const ICM42688_t *dev, uint32_t imu_us) {
+    const ICM_TimeSync_t *ts = &dev->ts;
+    int32_t d_imu = (int32_t)(imu_us - ts->imu_ref);
+
+    return ts->mcu_ref + (uint32_t)(int32_t)((float)d_imu * ts->rate);
+}
+
+// ================= 中断 + DMA 采集 =================
+
+static void ICM_Capture_Step(ICM42688_t *dev, int8_t status);
+
+// DMA 传输结束: 拉高片选, 解析, 回调
+static void ICM_IT_Complete(ICM42688_t *dev, int8_t status) {
+    uint16_t n = 0;
+
+    if (dev->cap_phase != 0) { // 按传输发起时的模式处理, 停止采集后最后一次传输也能正确收尾
+        ICM_Capture_Step(dev, status);
+        return;
+    }
+
+    if (status == 0) {
+        if (dev->it_mode == ICM_IT_DATA_READY) {
+            ICM_ParseRegs(&dev->it_buf[1], &dev->it_samples[0]);
+            n = 1;
+        } else {
+            n = ICM_ParseFifo(&dev->it_buf[1], (dev->it_len - 1) / ICM_FIFO_PKT3_LEN, dev->it_samples);
+            ICM_TS_ExtendSamples(dev, dev->it_samples, n);
+            // 水位中断由最后一个包写入触发: INT1 时刻与它的芯片时间构成一个同步点
+            if (n > 0) ICM42688_TS_AddPair(dev, dev->it_samples[n - 1].timestamp, dev->it_time);
+        }
+    } else {
+        dev->it_errors++;
+    }
+
+    dev->it_busy = 0;
+    if (n > 0 && dev->it_callback != NULL) dev->it_callback(dev, dev->it_samples, n);
+}
+
+#if ICM_USE_SPI_BUS
+static void ICM_IT_BusDone(SPIBus_Xfer_t *xfer, int8_t status) {
+    ICM_IT_Complete((ICM42688_t *)xfer->ctx, status);
+}
+#endif
+
+// 启动一次 it_buf / it_len 描述的 DMA 传输, 启动失败按传输出错处理
+static void ICM_IT_Transfer(ICM42688_t *dev) {
+#if ICM_USE_SPI_BUS
+    if (dev->bus_dev != NULL) {
+        dev->it_xfer.dev = dev->bus_dev;
+        dev->it_xfer.tx = dev->it_buf;
+        dev->it_xfer.rx = dev->it_buf;
+        dev->it_xfer.len = dev->it_len;
+        dev->it_xfer.priority = dev->bus_dev->priority;
+        dev->it_xfer.done = ICM_IT_BusDone;
+        dev->it_xfer.ctx = dev;
+        if (SPIBus_Submit(&dev->it_xfer) != 0) ICM_IT_Complete(dev, -1);
+        return;
+    }
+#endif
+
+    // 收发共用同一缓冲: 发送总是领先接收, 地址字节发出后才会被覆盖
+    HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_RESET);
+    if (HAL_SPI_TransmitReceive_DMA(dev->hspi, dev->it_buf, dev->it_buf, dev->it_len) != HAL_OK) {
+        HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_SET);
+        ICM_IT_Complete(dev, -1);
+    }
+}
+
+// 连续采集: 读 INT_STATUS 与 FIFO 计数 (0x2D ~ 0x2F 连续)
+static void ICM_Capture_ReadCount(ICM42688_t *dev) {
+    dev->cap_phase = 1;
+    dev->it_buf[0] = ICM42688_INT_STATUS | 0x80;
+    dev->it_len = 1 + 3;
+    ICM_IT_Transfer(dev);
+}
+
+// 连续采集: 读出本轮剩余的包 (单次最多 ICM_FIFO_BURST_MAX 个)
+static void ICM_Capture_ReadData(ICM42688_t *dev) {
+    uint16_t n = dev->cap_left;
+    if (n > ICM_FIFO_BURST_MAX) n = ICM_FIFO_BURST_MAX;
+
+    dev->cap_phase = 2;
+    dev->it_buf[0] = ICM42688_FIFO_DATA | 0x80;
+    dev->it_len = 1 + n * ICM_FIFO_PKT3_LEN;
+    ICM_IT_Transfer(dev);
+}
+
+// 连续采集状态机 (DMA 完成中断): 计数 -> 数据 (可多次) -> 有新中断则再读计数, 否则空闲
+static void ICM_Capture_Step(ICM42688_t *dev, int8_t status) {
+    ICM_CaptureStats_t *st = &dev->cap_stats;
+
+    if (status != 0) {
+        // FIFO 中剩下的数据由下一次水位中断继续读 (WM_GT_TH: 计数 >= 水位时每个 ODR 都会触发)
+        dev->it_errors++;
+        dev->cap_left = 0;
+    } else if (dev->cap_phase == 1) {
+        uint16_t count = (uint16_t)((dev->it_buf[2] << 8) | dev->it_buf[3]);
+
+        if (dev->it_buf[1] & 0x02) st->fifo_overflows++; // FIFO_FULL_INT
+        if (count > st->fifo_backlog_max) st->fifo_backlog_max = count;
+
+        // 没有积压时最后一个包就是触发本次中断的包, 记下供消费端做时间关联
+        if (count == dev->cap_watermark && !dev->cap_sync_valid) {
+            dev->cap_sync_pkt = dev->cap_wr + count - 1;
+            dev->cap_sync_mcu = dev->it_time;
+            dev->cap_sync_valid = 1;
+        }
+        dev->cap_left = count;
+    } else {
+        uint16_t n = (dev->it_len - 1) / ICM_FIFO_PKT3_LEN;
+        uint32_t wr = dev->cap_wr;
+        uint16_t i;
+
+        for (i = 0; i < n; i++) {
+            if (wr - dev->cap_rd >= dev->cap_size) break;
+            memcpy(&dev->cap_ring[(wr % dev->cap_size) * ICM_FIFO_PKT3_LEN],
+                   &dev->it_buf[1 + i * ICM_FIFO_PKT3_LEN], ICM_FIFO_PKT3_LEN);
+            wr++;
+        }
+        if (i < n) {
+            // 记下丢弃位置与个数, 消费端据此跨过这段空缺展开时间戳 (空缺可能超过 32ms)
+            if (!dev->cap_drop_valid) {
+                dev->cap_drop_pkt = wr;
+                dev->cap_drop_cnt = n - i;
+                __DMB();
+                dev->cap_drop_valid = 1;
+            } else if (dev->cap_drop_pkt == wr) {
+                dev->cap_drop_cnt += n - i;
+            }
+            st->ring_overruns += n - i;
+        }
+        st->packets += n;
+
+        __DMB(); // 包内容先于写计数可见
+        dev->cap_wr = wr;
+        if (wr - dev->cap_rd > st->ring_fill_max) st->ring_fill_max = (uint16_t)(wr - dev->cap_rd);
+        dev->cap_left -= n;
+    }
+
+    if (dev->cap_left > 0 && dev->it_mode == ICM_IT_CAPTURE) {
+        ICM_Capture_ReadData(dev);
+        return;
+    }
+
+    // 检查挂起标志与清 busy 之间不能被 INT1 打断, 否则这次中断会丢失
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!dev->cap_pending || dev->it_mode != ICM_IT_CAPTURE) {
+        dev->cap_phase = 0;
+        dev->it_busy = 0;
+        __set_PRIMASK(primask);
+        return;
+    }
+    dev->cap_pending = 0;
+    __set_PRIMASK(primask);
+
+    dev->it_time = ICM_TS_NOW();
+    ICM_Capture_ReadCount(dev);
+}
+
+/**
+ * @brief 启动 INT1 中断驱动的 DMA 采集
+ * @param mode      ICM_IT_DATA_READY 或 ICM_IT_FIFO_WM
+ * @param watermark FIFO 水位 (包), 仅 ICM_IT_FIFO_WM 使用, 1 ~ ICM_FIFO_BURST_MAX
+ * @param cb        采样回调, 在 DMA 完成中断里调用
+ * @note  INT1 配置为推挽、高电平有效、脉冲模式, MCU 侧 EXTI 设为上升沿触发
+ */
+int8_t ICM42688_IT_Start(ICM42688_t *dev, ICM_ITMode_t mode, uint16_t watermark, ICM_SampleCallback cb) {
+    uint8_t source;
+
+    if (mode == ICM_IT_DATA_READY) {
+        dev->it_buf[0] = ICM42688_TEMP_DATA1 | 0x80;
+        dev->it_len = 1 + 14;
+        source = 0x08; // UI_DRDY_INT1_EN
+    } else if (mode == ICM_IT_FIFO_WM || mode == ICM_IT_CAPTURE) {
+        if (watermark == 0 || watermark > ICM_FIFO_BURST_MAX) return -1;
+        if (dev->fifo_hires) return -1; // 中断缓冲按包 3 分配
+        if (mode == ICM_IT_CAPTURE && dev->cap_ring == NULL) return -1;
+        if (ICM42688_FIFO_Config(dev, ICM_FIFO_STREAM, watermark) != 0) return -1;
+        dev->it_buf[0] = ICM42688_FIFO_DATA | 0x80;
+        dev->it_len = 1 + watermark * ICM_FIFO_PKT3_LEN; // 连续采集模式每次按计数重新设置
+        dev->cap_watermark = watermark;
+        source = 0x04; // FIFO_THS_INT1_EN
+    } else {
+        return -1;
+    }
+
+    ICM_SetBank(dev, 0);
+    // INT_CONFIG: INT1 脉冲模式(bit2=0), 推挽(bit1=1), 高有效(bit0=1)
+    if (ICM_WriteReg(dev, ICM42688_INT_CONFIG, 0x03) != 0) return -1;
+    // INT_CONFIG0: DRDY 在读数据寄存器时清除, FIFO 水位在读 FIFO 数据时清除
+    if (ICM_WriteReg(dev, ICM42688_INT_CONFIG0, 0x28) != 0) return -1;
+    // INT_CONFIG1: 8us 脉冲 + 关闭去断言延时 (高 ODR 必需), INT_ASYNC_RESET 必须清 0
+    if (ICM_WriteReg(dev, ICM42688_INT_CONFIG1, 0x60) != 0) return -1;
+
+    dev->it_callback = cb;
+    dev->it_busy = 0;
+    dev->it_events = 0;
+    dev->it_missed = 0;
+    dev->it_errors = 0;
+    dev->it_mode = mode;
+
+    return ICM_WriteReg(dev, ICM42688_INT_SOURCE0, source);
+}
+
+/**
+ * @brief 停止中断采集
+ */
+int8_t ICM42688_IT_Stop(ICM42688_t *dev) {
+    dev->it_mode = ICM_IT_NONE;
+    while (dev->it_busy) {} // 等最后一次 DMA 结束
+
+    ICM_SetBank(dev, 0);
+    return ICM_WriteReg(dev, ICM42688_INT_SOURCE0, 0x00);
+}
+
+/**
+ * @brief INT1 外部中断: 启动一次 DMA 突发读取
+ */
+void ICM42688_IT_EXTI_Callback(ICM42688_t *dev) {
+    uint32_t now = ICM_TS_NOW();
+
+    if (dev->it_mode == ICM_IT_NONE) return;
+
+    dev->it_events++;
+    if (dev->it_busy) {
+        // 连续采集: 当前这轮读完后再查一次计数, 不算丢失
+        if (dev->it_mode == ICM_IT_CAPTURE) dev->cap_pending = 1;
+        else dev->it_missed++;
+        return;
+    }
+    dev->it_busy = 1;
+    dev->it_time = now;
+
+    if (dev->it_mode == ICM_IT_CAPTURE) {
+        ICM_Capture_ReadCount(dev);
+        return;
+    }
+    ICM_IT_Transfer(dev);
+}
+
+/**
+ * @brief SPI DMA 完成/出错回调
+ */
+void ICM42688_IT_SPI_Callback(ICM42688_t *dev, SPI_HandleTypeDef *hspi, int8_t status) {
+    if (hspi != dev->hspi || !dev->it_busy) return;
+#if ICM_USE_SPI_BUS
+    if (dev->bus_dev != NULL) return; // 由总线仲裁器回调
+#endif
+
+    HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_SET);
+    ICM_IT_Complete(dev, status);
+}
+
+// ================= 连续采集 =================
+
+/**
+ * @brief 启动连续采集
+ * @param ring      环形缓冲, ring_pkts x ICM_FIFO_PKT3_LEN 字节
+ * @param ring_pkts 容量 (包), 决定主循环最长可以多久不取数据 (32kHz 下 2048 包约 64ms)
+ * @param watermark FIFO 水位 (包), 决定中断频率; 每次中断都会读空 FIFO, 不受水位限制
+ * @note  先用 SetAccelConfig / SetGyroConfig 设置 ODR, 采集期间不要修改
+ */
+int8_t ICM42688_Capture_Start(ICM42688_t *dev, uint8_t *ring, uint16_t ring_pkts, uint16_t watermark) {
+    if (ring == NULL || ring_pkts == 0) return -1;
+    if (dev->it_mode != ICM_IT_NONE) return -1;
+
+    dev->cap_ring = ring;
+    dev->cap_size = ring_pkts;
+    dev->cap_wr = 0;
+    dev->cap_rd = 0;
+    dev->cap_phase = 0;
+    dev->cap_pending = 0;
+    dev->cap_left = 0;
+    dev->cap_period = ICM_SamplePeriod(dev);
+    dev->cap_ts_valid = 0;
+    dev->cap_sync_valid = 0;
+    dev->cap_drop_valid = 0;
+    memset(&dev->cap_stats, 0, sizeof(dev->cap_stats));
+
+    return ICM42688_IT_Start(dev, ICM_IT_CAPTURE, watermark, NULL);
+}
+
+/**
+ * @brief 从环形缓冲取出采样 (主循环调用)
+ * @note  时间戳在这里展开并检查连续性: 相邻两个采样间隔超过 1.5 个周期
+ *        视为缺失, 按间隔 / 周期推算缺失个数
+ */
+uint16_t ICM42688_Capture_Read(ICM42688_t *dev, ICM_RawData_t *out, uint16_t max) {
+    ICM_CaptureStats_t *st = &dev->cap_stats;
+    uint32_t rd = dev->cap_rd;
+    uint32_t avail = dev->cap_wr - rd;
+    uint16_t n = 0;
+
+    if (dev->cap_ring == NULL) return 0;
+    __DMB(); // 先读写计数, 再读包内容
+    if (avail > max) avail = max;
+
+    for (; avail > 0; avail--, rd++) {
+        ICM_RawData_t *r = &out[n];
+
+        if (ICM_ParseFifo(&dev->cap_ring[(rd % dev->cap_size) * ICM_FIFO_PKT3_LEN], 1, r) == 0) {
+            st->invalid++;
+            continue;
+        }
+
+        // 环形缓冲丢弃的那段之后: 先把展开基准推进到预计时刻
+        if (dev->cap_drop_valid && (int32_t)(rd - dev->cap_drop_pkt) >= 0) {
+            if (rd == dev->cap_drop_pkt && dev->cap_ts_valid && dev->ts.imu_valid) {
+                dev->ts.imu_last = dev->cap_last_ts + (uint32_t)((uint64_t)dev->cap_drop_cnt * dev->cap_period / 16);
+            }
+            dev->cap_drop_valid = 0;
+        }
+        r->timestamp = ICM_TS_Extend(dev, (uint16_t)r->timestamp);
+
+        if (dev->cap_ts_valid && dev->cap_period > 0) {
+            int32_t dt = (int32_t)(r->timestamp - dev->cap_last_ts);
+
+            if (dt <= 0) {
+                st->gaps++; // 时间倒退: 缺失超过展开范围, 个数无法推算
+            } else if ((uint32_t)dt * 32u > dev->cap_period * 3u) {
+                st->gaps++;
+                st->lost += ((uint32_t)dt * 16u + dev->cap_period / 2) / dev->cap_period - 1;
+            }
+        }
+        dev->cap_last_ts = r->timestamp;
+        dev->cap_ts_valid = 1;
+
+        // 中断记下的同步点: 轮到该包时配对, 已错过 (被丢弃) 则作废
+        if (dev->cap_sync_valid && (int32_t)(rd - dev->cap_sync_pkt) >= 0) {
+            if (rd == dev->cap_sync_pkt) ICM42688_TS_AddPair(dev, r->timestamp, dev->cap_sync_mcu);
+            dev->cap_sync_valid = 0;
+        }
+        n++;
+    }
+
+    __DMB(); // 包内容读完后才释放空间
+    dev->cap_rd = rd;
+    st->consumed += n;
+    return n;
+}
+
+/**
+ * @brief 环形缓冲中待取的包数
+ */
+uint16_t ICM42688_Capture_Available(const ICM42688_t *dev) {
+    return (uint16_t)(dev->cap_wr - dev->cap_rd);
+}
+
+/**
+ * @brief 读取采集统计
+ * @note  采样完整性: consumed / (consumed + lost); lost 中有 ring_overruns 个是环形缓冲端丢弃的
+ */
+void ICM42688_Capture_GetStats(const ICM42688_t *dev, ICM_CaptureStats_t *stats) {
+    *stats = dev->cap_stats;
+}
@@ -9,6 +9,35 @@ typedef SPI_HandleTypeDef* ICM_SPI_Handle;
 typedef GPIO_TypeDef* ICM_GPIO_Port;
 typedef uint16_t           ICM_GPIO_Pin;
 
+// 是否挂在 SPI 总线仲裁器上 (与 W25Q 等设备共用总线): 1=是, 0=独占 SPI
+#define ICM_USE_SPI_BUS    0
+
+#if ICM_USE_SPI_BUS
+#include "spi_bus.h"
+#endif
+
+// Q15 参考满量程相对 1g / 125dps 的移位, 与 accel_fs_shift / gyro_fs_shift 同一基准 (16g = 1g << 4, 2000dps = 125dps << 4)
+#define ICM_Q15_ACCEL_REF_SHIFT 4
+#define ICM_Q15_GYRO_REF_SHIFT  4
+
+// FIFO 单次突发读取的最大包数 (决定驱动内部静态缓冲大小: 包数 x 20 字节)
+#define ICM_FIFO_BURST_MAX 32
+
+// 时间关联使用的 MCU 时基: 32 位自由计数 (回绕周期需远大于同步间隔), 默认 DWT 周期计数器
+// 也可以换成 1MHz 的 32 位定时器, 例如 (TIM2->CNT) 与 1000000u
+#define ICM_TS_NOW()       (DWT->CYCCNT)
+#define ICM_TS_NOW_HZ      (SystemCoreClock)
+
+// 时间戳按 16 位展开: 相邻两次展开 (FIFO 包 / TS_Strobe) 的间隔必须小于 32ms
+
+// 同步点最小间隔 (IMU us): 间隔太短时中断抖动会淹没时钟偏差
+#define ICM_TS_MIN_SPAN_US 100000u
+// 锁定后残差超过该值 (us) 的同步点视为异常丢弃 (如 FIFO 积压导致配对错位)
+#define ICM_TS_REJECT_US   50u
+
+// 寄存器读取帧的最大数据长度 (句柄内预分配, 一次全双工事务完成读取)
+#define ICM_FRAME_MAX      16
+
 // ================= 寄存器定义 (Bank 0) =================
 #define ICM42688_REG_BANK_SEL      0x76
 #define ICM42688_WHO_AM_I          0x75
@@ -18,9 +47,93 @@ typedef uint16_t           ICM_GPIO_Pin;
 #define ICM42688_TEMP_DATA1        0x1D
 #define ICM42688_ACCEL_DATA_X1     0x1F
 #define ICM42688_GYRO_DATA_X1      0x25
+#define ICM42688_FIFO_CONFIG       0x16
+#define ICM42688_INT_STATUS        0x2D
+#define ICM42688_FIFO_COUNTH       0x2E
+#define ICM42688_FIFO_DATA         0x30
+#define ICM42688_SIGNAL_PATH_RESET 0x4B
+#define ICM42688_INTF_CONFIG0      0x4C
+#define ICM42688_INTF_CONFIG1      0x4D // bit2 RTC_MODE, bit1:0 CLKSEL
+#define ICM42688_FIFO_CONFIG1      0x5F
+#define ICM42688_FIFO_CONFIG2      0x60 // 水位 [7:0]
+#define ICM42688_FIFO_CONFIG3      0x61 // 水位 [11:8]
+#define ICM42688_INT_CONFIG        0x14
+#define ICM42688_INT_CONFIG0       0x63
+#define ICM42688_INT_CONFIG1       0x64
+#define ICM42688_INT_SOURCE0       0x65
+#define ICM42688_TMST_CONFIG       0x54
+#define ICM42688_GYRO_CONFIG1      0x51
+#define ICM42688_GYRO_ACCEL_CONFIG0 0x52
+#define ICM42688_ACCEL_CONFIG1     0x53
+#define ICM42688_APEX_DATA0        0x31 // STEP_CNT[7:0], DATA1 = [15:8]
+#define ICM42688_APEX_DATA2        0x33 // STEP_CADENCE (u6.2, 两步之间的采样数)
+#define ICM42688_APEX_DATA3        0x34 // bit2 DMP_IDLE, bit1:0 ACTIVITY_CLASS
+#define ICM42688_INT_STATUS2       0x37
+#define ICM42688_INT_STATUS3       0x38
+#define ICM42688_APEX_CONFIG0      0x56
+#define ICM42688_SMD_CONFIG        0x57
+#define ICM42688_INT_SOURCE1       0x66 // INT1: SMD / WOM
+#define ICM42688_INT_SOURCE4       0x69 // INT2: SMD / WOM
+
+// Bank 1
+#define ICM42688_B1_TMSTVAL0       0x62 // 20 位时间戳锁存值, 小端 (TMSTVAL2 只有低 4 位)
+#define ICM42688_B1_INTF_CONFIG5   0x7B // PIN9_FUNCTION[2:1]: INT2 / FSYNC / CLKIN
+#define ICM42688_B1_GYRO_STATIC2   0x0B // bit1 AAF_DIS, bit0 NF_DIS
+#define ICM42688_B1_GYRO_STATIC3   0x0C // AAF_DELT
+#define ICM42688_B1_GYRO_STATIC4   0x0D // AAF_DELTSQR[7:0]
+#define ICM42688_B1_GYRO_STATIC5   0x0E // AAF_BITSHIFT[7:4], AAF_DELTSQR[11:8]
+#define ICM42688_B1_GYRO_STATIC6   0x0F // X/Y/Z NF_COSWZ[7:0] (0x0F ~ 0x11)
+#define ICM42688_B1_GYRO_STATIC9   0x12 // COSWZ_SEL[5:3], COSWZ[8] [2:0]
+#define ICM42688_B1_GYRO_STATIC10  0x13 // NF_BW_SEL[6:4]
+
+// Bank 4
+#define ICM42688_B4_WOM_X_THR      0x4A // 1 LSB = 1g/256 (约 3.9mg), Y/Z 依次 0x4B/0x4C
+#define ICM42688_B4_INT_SOURCE6    0x4D // INT1: APEX 事件
+#define ICM42688_B4_INT_SOURCE7    0x4E // INT2: APEX 事件
+#define ICM42688_B4_OFFSET_USER0   0x77 // 用户偏移 OFFSET_USER0 ~ 8 (0x77 ~ 0x7F), 12 位补码
+
+// Bank 2
+#define ICM42688_B2_ACCEL_STATIC2  0x03 // AAF_DELT[6:1], bit0 AAF_DIS
+#define ICM42688_B2_ACCEL_STATIC3  0x04 // AAF_DELTSQR[7:0]
+#define ICM42688_B2_ACCEL_STATIC4  0x05 // AAF_BITSHIFT[7:4], AAF_DELTSQR[11:8]
 
 #define ICM42688_WHO_AM_I_VAL      0x47 // ICM-42688-P ID
 
+// 用户偏移寄存器单位 (ICM42688_SetUserOffset): 陀螺仪 1/32 dps, 加速度计 0.5mg, 范围 ±2047
+#define ICM_OFFSET_GYRO_LSB_PER_DPS  32.0f
+#define ICM_OFFSET_ACCEL_LSB_PER_G   2000.0f
+
+// FIFO 包格式
+#define ICM_FIFO_PKT3_LEN          16   // Header + Accel(6) + Gyro(6) + Temp(1) + Timestamp(2)
+#define ICM_FIFO_HEADER_MSG        0x80 // 1: FIFO 为空
+#define ICM_FIFO_HEADER_ACCEL      0x40
+#define ICM_FIFO_HEADER_GYRO       0x20
+#define ICM_FIFO_HEADER_20         0x10 // 1: 20 位高精度包
+
+// APEX 功能 (APEX_CONFIG0 bit)
+#define ICM_APEX_PEDOMETER         0x20
+#define ICM_APEX_TILT              0x10
+
+// APEX 事件 (ICM42688_APEX_GetEvents): 低 8 位 INT_STATUS2, 高 8 位 INT_STATUS3
+#define ICM_EVT_WOM_X              0x0001
+#define ICM_EVT_WOM_Y              0x0002
+#define ICM_EVT_WOM_Z              0x0004
+#define ICM_EVT_WOM                0x0007
+#define ICM_EVT_SMD                0x0008
+#define ICM_EVT_TAP                0x0100
+#define ICM_EVT_SLEEP              0x0200
+#define ICM_EVT_WAKE               0x0400
+#define ICM_EVT_TILT               0x0800
+#define ICM_EVT_STEP_OVF           0x1000
+#define ICM_EVT_STEP               0x2000
+
+// 高精度 FIFO 包 (包 4): Header + Accel(6) + Gyro(6) + Temp(2) + Timestamp(2) + 低 4 位扩展(3)
+// 加速度固定 ±16g, 角速度固定 ±2000dps, 与 ACCEL/GYRO_CONFIG0 的量程无关
+#define ICM_FIFO_PKT4_LEN          20
+#define ICM_HIRES_ACCEL_LSB_PER_G  8192.0f
+#define ICM_HIRES_GYRO_LSB_PER_DPS 131.0f
+#define ICM_HIRES_INVALID          (-524288) // 0x80000: 该轴无效 (如传感器未开启)
+
 // ================= 枚举定义 =================
 
 // 加速度量程
@@ -49,9 +162,82 @@ typedef enum {
     ICM_ODR_2kHz   = 0x05,
     ICM_ODR_1kHz   = 0x06,
     ICM_ODR_200Hz  = 0x07,
-    ICM_ODR_50Hz   = 0x08
+    ICM_ODR_100Hz  = 0x08,
+    ICM_ODR_50Hz   = 0x09,
+    ICM_ODR_25Hz   = 0x0A,
+    ICM_ODR_12_5Hz = 0x0B,
+    ICM_ODR_500Hz  = 0x0F
 } ICM_ODR_t;
 
+// DMP (APEX 运动引擎) 运行频率, APEX_CONFIG0 bit 1:0
+typedef enum {
+    ICM_DMP_ODR_25HZ  = 0x00,
+    ICM_DMP_ODR_500HZ = 0x01,
+    ICM_DMP_ODR_50HZ  = 0x02, // 计步/倾斜检测要求 50Hz
+    ICM_DMP_ODR_100HZ = 0x03
+} ICM_DmpODR_t;
+
+// 显著运动检测模式 (SMD_CONFIG bit 1:0)
+typedef enum {
+    ICM_SMD_WOM_ONLY = 0x01, // 只有运动唤醒
+    ICM_SMD_SHORT    = 0x02, // 运动唤醒 + 1s 内两次 WOM 判为显著运动
+    ICM_SMD_LONG     = 0x03  // 运动唤醒 + 3s 内两次 WOM 判为显著运动
+} ICM_SmdMode_t;
+
+// 中断引脚
+typedef enum {
+    ICM_INT1 = 0,
+    ICM_INT2 = 1
+} ICM_IntPin_t;
+
+// UI 滤波器带宽 (GYRO_ACCEL_CONFIG0, LN 模式), 按 ODR 的分数给出
+typedef enum {
+    ICM_UI_BW_ODR_2   = 0,  // ODR / 2
+    ICM_UI_BW_ODR_4   = 1,  // max(400Hz, ODR) / 4 (复位默认)
+    ICM_UI_BW_ODR_5   = 2,
+    ICM_UI_BW_ODR_8   = 3,
+    ICM_UI_BW_ODR_10  = 4,
+    ICM_UI_BW_ODR_16  = 5,
+    ICM_UI_BW_ODR_20  = 6,
+    ICM_UI_BW_ODR_40  = 7,
+    ICM_UI_BW_LL      = 14, // 低延迟: DEC2 以 max(400Hz, ODR) 运行
+    ICM_UI_BW_LL_8X   = 15  // 低延迟: DEC2 以 max(200Hz, 8 x ODR) 运行
+} ICM_UIFiltBW_t;
+
+// UI 滤波器阶数
+typedef enum {
+    ICM_FILT_ORD_1 = 0,
+    ICM_FILT_ORD_2 = 1,     // 复位默认
+    ICM_FILT_ORD_3 = 2
+} ICM_FiltOrder_t;
+
+// 陀螺仪陷波器 3dB 带宽 (GYRO_NF_BW_SEL)
+typedef enum {
+    ICM_NF_BW_1449HZ = 0,
+    ICM_NF_BW_680HZ  = 1,
+    ICM_NF_BW_329HZ  = 2,
+    ICM_NF_BW_162HZ  = 3,
+    ICM_NF_BW_80HZ   = 4,
+    ICM_NF_BW_40HZ   = 5,
+    ICM_NF_BW_20HZ   = 6,
+    ICM_NF_BW_10HZ   = 7
+} ICM_NotchBW_t;
+
+// FIFO 模式 (FIFO_CONFIG bit 7:6)
+typedef enum {
+    ICM_FIFO_BYPASS       = 0x00,
+    ICM_FIFO_STREAM       = 0x40, // 满了覆盖最旧数据
+    ICM_FIFO_STOP_ON_FULL = 0x80  // 满了停止写入
+} ICM_FifoMode_t;
+
+// INT1 中断驱动的采集模式
+typedef enum {
+    ICM_IT_NONE = 0,
+    ICM_IT_DATA_READY,   // 每个采样一次中断, DMA 读 14 字节数据寄存器
+    ICM_IT_FIFO_WM,      // FIFO 达到水位一次中断, DMA 一次读出 watermark 个包
+    ICM_IT_CAPTURE       // 连续采集: 每次中断读空 FIFO 存入环形缓冲 (ICM42688_Capture_Start)
+} ICM_ITMode_t;
+
 // ================= 数据结构 =================
 
 // 传感器原始数据
@@ -63,8 +249,55 @@ typedef struct {
     int16_t gyro_y_raw;
     int16_t gyro_z_raw;
     int16_t temp_raw;
+    uint32_t timestamp; // 芯片时间 (us, 由 FIFO 16 位时间戳展开), 读数据寄存器时为 0
 } ICM_RawData_t;
 
+// 抗混叠滤波器 (AAF) 寄存器值
+typedef struct {
+    uint8_t  delt;      // 1 ~ 63
+    uint16_t deltsqr;   // delt^2
+    uint8_t  bitshift;
+    uint16_t bw_hz;     // 该组参数对应的 3dB 带宽
+} ICM_AAFConfig_t;
+
+// 高精度 FIFO 原始数据 (20 位, 符号扩展到 int32)
+typedef struct {
+    int32_t  accel_x;
+    int32_t  accel_y;
+    int32_t  accel_z;
+    int32_t  gyro_x;
+    int32_t  gyro_y;
+    int32_t  gyro_z;
+    int16_t  temp_raw;  // 16 位, 刻度与 TEMP_DATA 相同
+    uint32_t timestamp; // 芯片时间 (us), 同 ICM_RawData_t
+} ICM_HiResData_t;
+
+// 传感器定点数据 (Q16.16: 低 16 位为小数), 单位同 ICM_PhysData_t
+typedef struct {
+    int32_t accel_x_g;
+    int32_t accel_y_g;
+    int32_t accel_z_g;
+    int32_t gyro_x_dps;
+    int32_t gyro_y_dps;
+    int32_t gyro_z_dps;
+    int32_t temp_c;
+} ICM_FixedData_t;
+
+// Q15 批量数据: 1.0 (32768) 对应参考满量程 16g / 2000dps, 与当前量程无关
+// 顺序: Accel X/Y/Z, Gyro X/Y/Z
+typedef struct {
+    int16_t accel[3];
+    int16_t gyro[3];
+} ICM_Q15Data_t;
+
+// Q15 换算校准: out = raw * gain + offset (在参考满量程下)
+// gain 为 Q15 (32767 约等于 1.0), offset 为 Q15 且范围 [-16384, 16383]
+// 加速度三轴的 gain 再乘以 ICM42688_SetAccelGain 的比例系数
+typedef struct {
+    int16_t gain_q15[6];
+    int16_t offset[6];
+} ICM_Q15Cal_t;
+
 // 传感器物理数据 (浮点)
 typedef struct {
     float accel_x_g;
@@ -76,17 +309,115 @@ typedef struct {
     float temp_c;
 } ICM_PhysData_t;
 
-// 设备句柄对象
+// IMU 时间 -> MCU 时间 关联器
+// IMU 时间为展开后的 32 位计数 (us), MCU 时间为 ICM_TS_NOW() 计数
+typedef struct {
+    uint32_t imu_last;     // 最近一次展开的 IMU 时间
+    uint8_t  imu_valid;    // imu_last 是否有效
+    uint32_t imu_ref;      // 参考点 IMU 时间
+    uint32_t mcu_ref;      // 参考点 MCU 时间 (滤波后)
+    float    rate;         // MCU 计数 / IMU us (估计值)
+    float    rate_nominal; // MCU 计数 / us (标称值)
+    float    drift_ppm;    // IMU 时钟相对 MCU 的偏差, 正值表示 IMU 偏慢
+    int32_t  jitter_max;   // 锁定后最大配对残差 (MCU 计数)
+    uint32_t pairs;        // 已采用的同步点数
+    uint32_t rejected;     // 被丢弃的异常同步点数
+    uint8_t  reject_run;   // 连续丢弃次数, 过多则重新锁定
+} ICM_TimeSync_t;
+
+// 连续采集统计: 前四项在 DMA 中断中更新, 其余在 ICM42688_Capture_Read 中更新
 typedef struct {
+    uint32_t packets;          // 从 FIFO 读出的包数
+    uint32_t fifo_overflows;   // 读到 FIFO_FULL 的次数 (芯片端已覆盖旧数据)
+    uint32_t ring_overruns;    // 环形缓冲已满而丢弃的包数 (消费太慢)
+    uint16_t fifo_backlog_max; // FIFO 中最大积压包数 (芯片 FIFO 2KB, 最多 128 个包 3)
+    uint16_t ring_fill_max;    // 环形缓冲最大占用包数
+    uint32_t consumed;         // 已被 Capture_Read 取走的有效采样数
+    uint32_t invalid;          // 包头无效而跳过的包数
+    uint32_t gaps;             // 时间戳不连续的次数
+    uint32_t lost;             // 按时间戳推算的缺失采样数 (包含芯片端与环形缓冲端)
+} ICM_CaptureStats_t;
+
+struct ICM42688;
+
+// 中断采集完成回调 (在 SPI DMA 中断中调用)
+typedef void (*ICM_SampleCallback)(struct ICM42688 *dev, const ICM_RawData_t *samples, uint16_t count);
+
+// 设备句柄对象
+typedef struct ICM42688 {
     // 硬件接口
     ICM_SPI_Handle  hspi;
     ICM_GPIO_Port   cs_port;
     ICM_GPIO_Pin    cs_pin;
+    uint8_t         bank;        // 当前寄存器 Bank 缓存, 0xFF 表示未知
+    uint8_t         frame[1 + ICM_FRAME_MAX]; // 寄存器读取帧: [地址][数据...], 收发共用
+#if ICM_USE_SPI_BUS
+    SPIBus_Device_t *bus_dev;    // 总线设备, NULL 表示独占 SPI
+#endif
     
     // 配置状态 (用于换算)
     float           accel_scale; // g/LSB
     float           gyro_scale;  // dps/LSB
+    uint8_t         accel_config0; // 最近一次写入的 ACCEL_CONFIG0, APEX 关闭时恢复
+    uint8_t         gyro_config0;
+    uint8_t         accel_fs_shift; // 量程 = 1g << shift (16g: 4 ... 2g: 1)
+    uint8_t         gyro_fs_shift;  // 量程 = 125dps << shift (2000dps: 4 ... 125dps: 0)
+    float           accel_gain[3];  // 加速度计比例校准 (ReadData 与 Q15 换算使用), 默认 1.0
+    int16_t         offset_user[6]; // 已写入芯片的用户偏移, 顺序 Accel X/Y/Z, Gyro X/Y/Z
+
+    // Q15 换算: 校准值与按当前量程预先合成的系数 (低 16 位 gain, 高 16 位 offset 预乘)
+    ICM_Q15Cal_t    q15_cal;
+    uint32_t        q15_coef[6];
+    uint8_t         q15_accel_shift; // 加速度系数的小数位: 15, 16g 量程下为 14 (增益可大于 1)
     
+    // FIFO 状态
+    ICM_FifoMode_t  fifo_mode;
+    uint8_t         fifo_pkt_len; // 当前包长度 (字节)
+    uint8_t         fifo_hires;   // 1: 20 位高精度包
+
+    // 中断 + DMA 采集状态
+    volatile ICM_ITMode_t it_mode;
+    volatile uint8_t      it_busy;     // DMA 传输进行中
+    uint16_t              it_len;      // 每次 DMA 传输的字节数 (含地址字节)
+    ICM_SampleCallback    it_callback;
+    uint8_t               it_buf[1 + ICM_FIFO_BURST_MAX * ICM_FIFO_PKT3_LEN]; // 收发共用
+    ICM_RawData_t         it_samples[ICM_FIFO_BURST_MAX];
+    volatile uint32_t     it_events;   // 收到的 INT1 次数
+    volatile uint32_t     it_missed;   // 上一次 DMA 未完成时又来了中断
+    volatile uint32_t     it_errors;   // DMA 启动/传输失败次数
+    volatile uint32_t     it_time;     // 最近一次 INT1 的 MCU 时间 (ICM_TS_NOW)
+#if ICM_USE_SPI_BUS
+    SPIBus_Xfer_t         it_xfer;
+#endif
+
+    // 连续采集: 环形缓冲存放原始包 3, 读写计数自由增长, 下标 = 计数 % cap_size
+    uint8_t              *cap_ring;
+    uint16_t              cap_size;     // 容量 (包)
+    uint16_t              cap_watermark;
+    volatile uint32_t     cap_wr;       // DMA 完成中断写入
+    volatile uint32_t     cap_rd;       // Capture_Read 读出
+    volatile uint8_t      cap_phase;    // 0: 空闲, 1: 读 INT_STATUS + FIFO_COUNT, 2: 读 FIFO 数据
+    volatile uint8_t      cap_pending;  // 传输期间又来了 INT1, 读完后再查一次计数
+    uint16_t              cap_left;     // 本轮还没读出的包数
+    uint32_t              cap_period;   // 采样周期 (1/16 us), 用于检查时间戳连续性
+    uint32_t              cap_last_ts;  // 上一个采样的展开时间戳
+    uint8_t               cap_ts_valid;
+    volatile uint8_t      cap_sync_valid; // 下面的同步点待消费端配对
+    uint32_t              cap_sync_pkt;   // 触发水位中断的包的写入计数
+    uint32_t              cap_sync_mcu;
+    volatile uint8_t      cap_drop_valid; // 环形缓冲满时的丢弃记录, 待消费端处理
+    uint32_t              cap_drop_pkt;   // 丢弃后第一个写入的包的写入计数
+    uint32_t              cap_drop_cnt;   // 该处丢弃的包数
+    ICM_CaptureStats_t    cap_stats;
+
+    // APEX 状态
+    ICM_DmpODR_t    apex_odr;
+    uint8_t         apex_features; // 已开启的 ICM_APEX_xxx
+    uint8_t         apex_wom;      // 1: 运动唤醒/SMD 已开启
+
+    // 时间戳关联
+    ICM_TimeSync_t  ts;
+
     // 数据
     ICM_RawData_t   raw_data;
     ICM_PhysData_t  data;
@@ -99,12 +430,95 @@ typedef struct {
 
 // 初始化
 int8_t ICM42688_Init(ICM42688_t *dev, ICM_SPI_Handle hspi, ICM_GPIO_Port cs_port, ICM_GPIO_Pin cs_pin);
+#if ICM_USE_SPI_BUS
+// 通过总线仲裁器初始化 (SPI 句柄与片选取自 bus_dev)
+int8_t ICM42688_InitOnBus(ICM42688_t *dev, SPIBus_Device_t *bus_dev);
+#endif
 
 // 配置
 int8_t ICM42688_SetAccelConfig(ICM42688_t *dev, ICM_AccelRange_t range, ICM_ODR_t odr);
 int8_t ICM42688_SetGyroConfig(ICM42688_t *dev, ICM_GyroRange_t range, ICM_ODR_t odr);
+float  ICM42688_GetSampleRate(const ICM42688_t *dev); // Hz, 两者中较快的 ODR
+// 外部时钟 (引脚 9 CLKIN): 多片共用时钟时采样完全同频
+int8_t ICM42688_SetClockIn(ICM42688_t *dev, uint8_t enable);
+
+// 片上滤波 (修改 Bank 1/2 寄存器, 中断采集运行时不要调用)
+int8_t ICM42688_SetGyroUIFilter(ICM42688_t *dev, ICM_UIFiltBW_t bw, ICM_FiltOrder_t order);
+int8_t ICM42688_SetAccelUIFilter(ICM42688_t *dev, ICM_UIFiltBW_t bw, ICM_FiltOrder_t order);
+// 按期望带宽查表 (取不低于 bw_hz 的最小档位, 超出范围取最高档), 返回实际带宽
+uint16_t ICM42688_AAF_Lookup(uint16_t bw_hz, ICM_AAFConfig_t *cfg);
+// AAF 带宽 42 ~ 3979Hz, bw_hz = 0 关闭 AAF
+int8_t ICM42688_SetGyroAAF(ICM42688_t *dev, uint16_t bw_hz);
+int8_t ICM42688_SetAccelAAF(ICM42688_t *dev, uint16_t bw_hz);
+// 陀螺仪陷波器: 每轴中心频率 1000 ~ 3000Hz, freq_hz = NULL 关闭
+int8_t ICM42688_SetGyroNotch(ICM42688_t *dev, const float freq_hz[3], ICM_NotchBW_t bw);
+
+// APEX 运动引擎: 加速度计切到低功耗模式、陀螺仪关闭, 事件经 INTx 唤醒 MCU
+// INTx 配置为锁存模式, 读取 ICM42688_APEX_GetEvents 后释放
+int8_t ICM42688_APEX_SetDmpODR(ICM42688_t *dev, ICM_DmpODR_t odr);
+int8_t ICM42688_APEX_StartWOM(ICM42688_t *dev, uint16_t thr_mg, ICM_SmdMode_t mode, ICM_IntPin_t pin);
+int8_t ICM42688_APEX_Start(ICM42688_t *dev, uint8_t features, ICM_IntPin_t pin);
+int8_t ICM42688_APEX_Stop(ICM42688_t *dev);
+int8_t ICM42688_APEX_GetEvents(ICM42688_t *dev, uint16_t *events);
+// activity: 0 未知, 1 步行, 2 跑步
+int8_t ICM42688_APEX_GetSteps(ICM42688_t *dev, uint16_t *steps, uint8_t *cadence, uint8_t *activity);
 
 // 数据读取
-int8_t ICM42688_ReadData(ICM42688_t *dev);
+int8_t ICM42688_ReadData(ICM42688_t *dev); // 原始数据 + 浮点换算
+int8_t ICM42688_ReadRaw(ICM42688_t *dev);  // 只读原始数据 (raw_data), 不做换算
+
+// 定点换算 (不使用 FPU)
+void   ICM42688_ConvertFixed(const ICM42688_t *dev, const ICM_RawData_t *raw, ICM_FixedData_t *out);
+void   ICM42688_SetQ15Cal(ICM42688_t *dev, const ICM_Q15Cal_t *cal);
+void   ICM42688_ConvertBatchQ15(const ICM42688_t *dev, const ICM_RawData_t *in, ICM_Q15Data_t *out, uint16_t n);
+
+// 校准: 偏移写入芯片 (输出数据已扣除, 不占 MCU 时间); 比例系数由 MCU 在换算时乘上
+// offset 顺序 Accel X/Y/Z, Gyro X/Y/Z, 单位见 ICM_OFFSET_xxx_LSB_PER_xxx
+int8_t ICM42688_SetUserOffset(ICM42688_t *dev, const int16_t offset[6]);
+// gain 为 NULL 时恢复 1.0; 范围 (0, 2.0), 超出返回 -1 (浮点与 Q15 路径都按同一增益换算)
+int8_t ICM42688_SetAccelGain(ICM42688_t *dev, const float gain[3]);
+
+// FIFO
+int8_t ICM42688_FIFO_Config(ICM42688_t *dev, ICM_FifoMode_t mode, uint16_t watermark);
+int8_t ICM42688_FIFO_Flush(ICM42688_t *dev);
+int8_t ICM42688_FIFO_GetCount(ICM42688_t *dev, uint16_t *count);
+int8_t ICM42688_FIFO_Read(ICM42688_t *dev, ICM_RawData_t *out, uint16_t max, uint16_t *got);
+// 20 位高精度包: 开关后需重新 FIFO_Config; 开启后只能用 FIFO_ReadHiRes 读取
+int8_t ICM42688_FIFO_SetHiRes(ICM42688_t *dev, uint8_t enable);
+int8_t ICM42688_FIFO_ReadHiRes(ICM42688_t *dev, ICM_HiResData_t *out, uint16_t max, uint16_t *got);
+void   ICM42688_ConvertHiRes(const ICM_HiResData_t *in, ICM_PhysData_t *out);
+// FIFO 读取并直接从包字节换算为 Q15 (不经过 ICM_RawData_t)
+int8_t ICM42688_FIFO_ReadQ15(ICM42688_t *dev, ICM_Q15Data_t *out, uint16_t max, uint16_t *got);
+
+// 时间戳: FIFO 包带 16 位芯片时间戳; 时间关联把它换算成 MCU 时间并估计时钟偏差
+// 中断 FIFO 水位模式下, 每次中断自动用 INT1 时刻与最后一个包配对; 轮询模式下定期调用 TS_Strobe
+int8_t   ICM42688_TS_Enable(ICM42688_t *dev);
+void     ICM42688_TS_Reset(ICM42688_t *dev);
+int8_t   ICM42688_TS_Strobe(ICM42688_t *dev);
+void     ICM42688_TS_AddPair(ICM42688_t *dev, uint32_t imu_us, uint32_t mcu_now);
+// 采样的 timestamp -> MCU 时间 (ICM_TS_NOW 计数)
+uint32_t ICM42688_TS_ToMcu(const ICM42688_t *dev, uint32_t imu_us);
+
+// 中断 + DMA 采集 (启动后不要再调用阻塞式读取函数)
+int8_t ICM42688_IT_Start(ICM42688_t *dev, ICM_ITMode_t mode, uint16_t watermark, ICM_SampleCallback cb);
+int8_t ICM42688_IT_Stop(ICM42688_t *dev);
+// 在 HAL_GPIO_EXTI_Callback 中 (INT1 引脚) 调用
+void   ICM42688_IT_EXTI_Callback(ICM42688_t *dev);
+// 在 HAL_SPI_TxRxCpltCallback / HAL_SPI_ErrorCallback 中调用 (使用总线仲裁器时不需要)
+void   ICM42688_IT_SPI_Callback(ICM42688_t *dev, SPI_HandleTypeDef *hspi, int8_t status);
+
+/*
+ * 连续采集 (面向 8k ~ 32kHz ODR): 水位中断 -> DMA 读 FIFO 计数 -> DMA 读空 FIFO -> 环形缓冲,
+ * 主循环用 Capture_Read 取数据 (解析与时间戳展开在这里完成, 中断里只做拷贝).
+ * 停止用 ICM42688_IT_Stop; EXTI / SPI 回调与 IT 模式相同.
+ * 缺失采样由相邻时间戳推算; 芯片端 (FIFO 溢出) 的单次连续缺失需短于 32ms (16 位时间戳展开的限制),
+ * 环形缓冲端的丢弃位置与个数有记录, 不受此限制.
+ */
+// ring: ring_pkts x 16 字节, 由调用者分配; watermark: 1 ~ ICM_FIFO_BURST_MAX
+int8_t   ICM42688_Capture_Start(ICM42688_t *dev, uint8_t *ring, uint16_t ring_pkts, uint16_t watermark);
+// 取出最多 max 个采样 (timestamp 已展开), 返回个数
+uint16_t ICM42688_Capture_Read(ICM42688_t *dev, ICM_RawData_t *out, uint16_t max);
+uint16_t ICM42688_Capture_Available(const ICM42688_t *dev);
+void     ICM42688_Capture_GetStats(const ICM42688_t *dev, ICM_CaptureStats_t *stats);
 
 #endif
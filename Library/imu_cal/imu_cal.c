@@ -0,0 +1,248 @@
+#include "imu_cal.h"
+#include <math.h>
+#include <stddef.h> // for offsetof
+#include <string.h> // for memset
+
+// ================= 内部静态辅助函数 =================
+
+static void IMUCal_ResetWindow(IMUCal_t *cal) {
+    cal->n = 0;
+    memset(cal->sum, 0, sizeof(cal->sum));
+    memset(cal->sq, 0, sizeof(cal->sq));
+}
+
+static uint16_t IMUCal_Checksum(const IMUCal_Coef_t *coef) {
+    const uint8_t *p = (const uint8_t *)coef;
+    uint16_t sum = 0;
+
+    for (uint16_t i = 0; i < offsetof(IMUCal_Coef_t, checksum); i++) sum += p[i];
+    return sum;
+}
+
+static int16_t IMUCal_Round(float x) {
+    return (int16_t)((x >= 0.0f) ? (x + 0.5f) : (x - 0.5f));
+}
+
+// 写芯片; 采集进行中时只标记, 由 IMUCal_Apply 补写; 写失败时保持标记, 下一个静止窗口重试
+static void IMUCal_Commit(IMUCal_t *cal) {
+    cal->dirty = 1;
+    if (cal->dev->it_mode != ICM_IT_NONE) return;
+    if (IMUCal_Apply(cal) == 0) cal->settle = 1;
+}
+
+// 静止窗口: 更新陀螺零偏
+static void IMUCal_GyroWindow(IMUCal_t *cal, const float mean[6]) {
+    float k = cal->dev->gyro_scale * ICM_OFFSET_GYRO_LSB_PER_DPS; // LSB -> 寄存器单位
+    float limit = IMUCAL_GYRO_BIAS_MAX_DPS / cal->dev->gyro_scale;
+    uint8_t changed = 0;
+
+    // 上次的结果还没写进芯片: 读数仍按旧偏移, 据此再估计会越调越偏, 只补写
+    if (cal->dirty) {
+        IMUCal_Commit(cal);
+        return;
+    }
+
+    for (uint8_t i = 0; i < 3; i++) {
+        if (fabsf(mean[3 + i]) > limit) return;
+    }
+
+    // 读数已含当前寄存器偏移, 均值即残差: 理想寄存器值 = 当前值 - 残差, 平滑后再取整
+    for (uint8_t i = 0; i < 3; i++) {
+        float ideal = cal->coef.offset[3 + i] - mean[3 + i] * k;
+        if (cal->gyro_locked) cal->gyro_off[i] += IMUCAL_GYRO_ALPHA * (ideal - cal->gyro_off[i]);
+        else cal->gyro_off[i] = ideal;
+
+        // 0.75 LSB 回差: 估计值在两个整数之间抖动时不反复写芯片
+        if (fabsf(cal->gyro_off[i] - cal->coef.offset[3 + i]) > 0.75f) {
+            cal->coef.offset[3 + i] = IMUCal_Round(cal->gyro_off[i]);
+            changed = 1;
+        }
+    }
+    cal->gyro_locked = 1;
+    cal->coef.flags |= IMUCAL_HAS_GYRO;
+    cal->stats.gyro_updates++;
+
+    if (changed) IMUCal_Commit(cal);
+}
+
+// 静止窗口: 六面法采集, 检查摆放方向
+static void IMUCal_AccelWindow(IMUCal_t *cal, const float mean[6]) {
+    uint8_t pos = (uint8_t)cal->accel_pos;
+    uint8_t axis = pos / 2;
+    float sign = (pos & 1) ? -1.0f : 1.0f;
+    float g[3];
+
+    for (uint8_t i = 0; i < 3; i++) g[i] = mean[i] * cal->dev->accel_scale;
+    if (g[axis] * sign < 0.5f) return; // 方向不对
+
+    for (uint8_t i = 0; i < 3; i++) cal->accel_sum[pos][i] += g[i];
+    if (++cal->accel_windows[pos] >= IMUCAL_ACCEL_WINDOWS) {
+        cal->accel_done |= (uint8_t)(1u << pos);
+        cal->accel_pos = -1;
+    }
+}
+
+// 窗口结束: 64 位整数算 n^2 * 方差 (n <= 1024 时不会溢出), 判定静止
+static void IMUCal_EndWindow(IMUCal_t *cal) {
+    float gthr = cal->gyro_still_dps / cal->dev->gyro_scale;
+    float athr = cal->accel_still_g / cal->dev->accel_scale;
+    float n = (float)cal->n;
+    float mean[6];
+    uint8_t still = 1;
+
+    for (uint8_t i = 0; i < 6; i++) {
+        int64_t var_n2 = (int64_t)cal->n * cal->sq[i] - (int64_t)cal->sum[i] * cal->sum[i];
+        float var = (float)var_n2 / (n * n);
+        float thr = (i < 3) ? athr : gthr;
+
+        mean[i] = (float)cal->sum[i] / n;
+        if (var > thr * thr) still = 0;
+    }
+    IMUCal_ResetWindow(cal);
+    cal->stats.windows++;
+
+    if (!still) return;
+    cal->stats.still++;
+    if (cal->settle > 0) {
+        cal->settle--;
+        return;
+    }
+
+    if (cal->gyro_online) IMUCal_GyroWindow(cal, mean);
+    if (cal->accel_pos >= 0) IMUCal_AccelWindow(cal, mean);
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化, 系数从驱动句柄中的当前状态取得
+ */
+void IMUCal_Init(IMUCal_t *cal, ICM42688_t *dev) {
+    memset(cal, 0, sizeof(*cal));
+    cal->dev = dev;
+    cal->gyro_online = 1;
+    cal->gyro_still_dps = IMUCAL_GYRO_STILL_DPS;
+    cal->accel_still_g = IMUCAL_ACCEL_STILL_G;
+    cal->accel_pos = -1;
+
+    for (uint8_t i = 0; i < 6; i++) cal->coef.offset[i] = dev->offset_user[i];
+    for (uint8_t i = 0; i < 3; i++) {
+        cal->coef.accel_gain[i] = dev->accel_gain[i];
+        cal->gyro_off[i] = dev->offset_user[3 + i];
+    }
+}
+
+void IMUCal_SetStillness(IMUCal_t *cal, float gyro_dps, float accel_g) {
+    cal->gyro_still_dps = gyro_dps;
+    cal->accel_still_g = accel_g;
+}
+
+void IMUCal_EnableGyroOnline(IMUCal_t *cal, uint8_t enable) {
+    cal->gyro_online = enable ? 1 : 0;
+}
+
+/**
+ * @brief 输入一批原始采样, 每满一个窗口做一次静止判定
+ */
+void IMUCal_Update(IMUCal_t *cal, const ICM_RawData_t *samples, uint16_t n) {
+    for (uint16_t k = 0; k < n; k++) {
+        const ICM_RawData_t *s = &samples[k];
+        int16_t v[6] = { s->accel_x_raw, s->accel_y_raw, s->accel_z_raw,
+                         s->gyro_x_raw,  s->gyro_y_raw,  s->gyro_z_raw };
+
+        for (uint8_t i = 0; i < 6; i++) {
+            cal->sum[i] += v[i];
+            cal->sq[i] += (int32_t)v[i] * v[i];
+        }
+        if (++cal->n >= IMUCAL_WINDOW) IMUCal_EndWindow(cal);
+    }
+}
+
+/**
+ * @brief 开始采集一个位置 (重新采集会覆盖该位置之前的结果)
+ */
+void IMUCal_AccelCapture(IMUCal_t *cal, IMUCal_Pos_t pos) {
+    if ((uint8_t)pos > IMUCAL_POS_Z_DOWN) return;
+
+    cal->accel_done &= (uint8_t)~(1u << pos);
+    cal->accel_windows[pos] = 0;
+    for (uint8_t i = 0; i < 3; i++) cal->accel_sum[pos][i] = 0.0f;
+    cal->accel_pos = (int8_t)pos;
+    IMUCal_ResetWindow(cal); // 丢掉摆放过程中的数据
+}
+
+uint8_t IMUCal_AccelDone(const IMUCal_t *cal) {
+    return cal->accel_done;
+}
+
+/**
+ * @brief 六面法求解: 偏移 = (朝上 + 朝下) / 2, 比例 = 2 / (朝上 - 朝下)
+ * @note  读数已含芯片当前偏移, 新偏移寄存器 = 旧值 - 残差
+ */
+int8_t IMUCal_AccelSolve(IMUCal_t *cal) {
+    int16_t offset[3];
+    float gain[3];
+
+    if (cal->accel_done != 0x3F) return -1;
+
+    for (uint8_t a = 0; a < 3; a++) {
+        float up = cal->accel_sum[a * 2][a] / IMUCAL_ACCEL_WINDOWS;
+        float down = cal->accel_sum[a * 2 + 1][a] / IMUCAL_ACCEL_WINDOWS;
+        float bias = (up + down) * 0.5f;
+        float half = (up - down) * 0.5f;
+
+        if (fabsf(bias) > 0.5f || half < 0.8f || half > 1.2f) return -2;
+
+        offset[a] = IMUCal_Round(cal->coef.offset[a] - bias * ICM_OFFSET_ACCEL_LSB_PER_G);
+        gain[a] = 1.0f / half;
+    }
+
+    for (uint8_t a = 0; a < 3; a++) {
+        cal->coef.offset[a] = offset[a];
+        cal->coef.accel_gain[a] = gain[a];
+    }
+    cal->coef.flags |= IMUCAL_HAS_ACCEL;
+    cal->accel_done = 0;
+
+    IMUCal_Commit(cal);
+    return 0;
+}
+
+/**
+ * @brief 导出系数 (填好 magic 与校验和)
+ */
+void IMUCal_Export(IMUCal_t *cal, IMUCal_Coef_t *out) {
+    cal->coef.magic = IMUCAL_MAGIC;
+    cal->coef.checksum = IMUCal_Checksum(&cal->coef);
+    *out = cal->coef;
+}
+
+/**
+ * @brief 载入保存的系数并写入芯片 (9 次寄存器写, 约几十微秒)
+ */
+int8_t IMUCal_Load(IMUCal_t *cal, const IMUCal_Coef_t *in) {
+    if (in->magic != IMUCAL_MAGIC || in->checksum != IMUCal_Checksum(in)) return -1;
+
+    cal->coef = *in;
+    for (uint8_t i = 0; i < 3; i++) cal->gyro_off[i] = in->offset[3 + i];
+    // 保存过零偏则在线估计直接进入平滑阶段, 温漂慢慢跟踪
+    cal->gyro_locked = (in->flags & IMUCAL_HAS_GYRO) ? 1 : 0;
+
+    return (IMUCal_Apply(cal) == 0) ? 0 : -2;
+}
+
+/**
+ * @brief 把当前系数写入芯片, 并更新驱动的加速度计比例系数
+ */
+int8_t IMUCal_Apply(IMUCal_t *cal) {
+    if (ICM42688_SetAccelGain(cal->dev, cal->coef.accel_gain) != 0) return -1;
+    if (ICM42688_SetUserOffset(cal->dev, cal->coef.offset) != 0) return -1;
+
+    cal->dirty = 0;
+    cal->stats.writes++;
+    return 0;
+}
+
+void IMUCal_GetStats(const IMUCal_t *cal, IMUCal_Stats_t *stats) {
+    *stats = cal->stats;
+}
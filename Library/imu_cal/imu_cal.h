@@ -0,0 +1,135 @@
+#ifndef __IMU_CAL_H__
+#define __IMU_CAL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "icm42688.h"
+
+/*
+ * ICM42688 校准: 静止时在线估计陀螺零偏 + 六面法加速度计校准.
+ *
+ * 偏移写入芯片的用户偏移寄存器 (Bank 4 OFFSET_USER), 之后读到的数据 (寄存器 / FIFO)
+ * 已经扣除偏移, MCU 端每个采样零开销; 加速度计比例系数由驱动在浮点 / Q15 换算时乘上.
+ *
+ * 系数 (IMUCal_Coef_t, 32 字节) 可导出保存到 EEPROM / Flash, 上电后 IMUCal_Load
+ * 写回芯片即可使用, 不再需要开机静置求平均.
+ *
+ * 数据来源不限: IMUCal_Update 输入原始采样 (ReadRaw / FIFO_Read / Capture_Read 均可),
+ * 按窗口统计均值与方差, 各轴方差都低于阈值的窗口视为静止.
+ * 写芯片是阻塞 SPI 操作, IMUCal_Update 需在主循环中调用; 中断 / 连续采集模式运行时
+ * 只更新系数, 停止采集后用 IMUCal_Apply 写入.
+ */
+
+// ================= 配置区域 =================
+
+/* 统计窗口 (采样数), 上限 1024 (方差用 64 位整数精确计算) */
+#define IMUCAL_WINDOW            256
+
+/* 静止判定: 窗口内每轴标准差上限 */
+#define IMUCAL_GYRO_STILL_DPS    0.3f
+#define IMUCAL_ACCEL_STILL_G     0.01f
+
+/* 静止窗口的陀螺均值超过该值时不更新零偏 (匀速转动也可能方差很小) */
+#define IMUCAL_GYRO_BIAS_MAX_DPS 5.0f
+
+/* 首次估计直接采用, 之后每个静止窗口按该系数平滑 */
+#define IMUCAL_GYRO_ALPHA        0.25f
+
+/* 六面法每个位置需要的静止窗口数 */
+#define IMUCAL_ACCEL_WINDOWS     4
+
+#define IMUCAL_MAGIC             0x4C414349u // "ICAL"
+
+// ================= 数据结构 =================
+
+/* 系数有效标志 */
+#define IMUCAL_HAS_GYRO   0x01
+#define IMUCAL_HAS_ACCEL  0x02
+
+/* 六面法位置: 对应轴朝上 (读数 +1g) / 朝下 (-1g) */
+typedef enum {
+    IMUCAL_POS_X_UP = 0,
+    IMUCAL_POS_X_DOWN,
+    IMUCAL_POS_Y_UP,
+    IMUCAL_POS_Y_DOWN,
+    IMUCAL_POS_Z_UP,
+    IMUCAL_POS_Z_DOWN
+} IMUCal_Pos_t;
+
+/* 可持久化的系数 */
+typedef struct {
+    uint32_t magic;
+    int16_t  offset[6];     // 芯片用户偏移, 顺序与单位同 ICM42688_SetUserOffset
+    float    accel_gain[3]; // 加速度计比例系数
+    uint16_t flags;         // IMUCAL_HAS_xxx
+    uint16_t checksum;      // 前面各字节之和
+} IMUCal_Coef_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t windows;       // 已统计的窗口数
+    uint32_t still;         // 其中静止的窗口数
+    uint32_t gyro_updates;  // 零偏估计更新次数
+    uint32_t writes;        // 写芯片次数
+} IMUCal_Stats_t;
+
+typedef struct {
+    ICM42688_t    *dev;
+    IMUCal_Coef_t  coef;          // 当前系数
+    uint8_t        gyro_online;   // 1: 静止时在线更新陀螺零偏
+    uint8_t        dirty;         // coef 已更新但还没写入芯片
+    float          gyro_still_dps;
+    float          accel_still_g;
+
+    // 窗口累加 (原始 LSB)
+    uint16_t       n;
+    int32_t        sum[6];
+    int64_t        sq[6];
+    uint8_t        settle;        // 写芯片后跳过的窗口数 (FIFO 中仍有旧偏移的数据)
+
+    // 陀螺零偏 (寄存器单位, 浮点保存以便平滑)
+    uint8_t        gyro_locked;
+    float          gyro_off[3];
+
+    // 六面法
+    int8_t         accel_pos;     // 正在采集的位置, -1 表示无
+    uint8_t        accel_done;    // 已完成的位置 (bit = IMUCal_Pos_t)
+    uint8_t        accel_windows[6];
+    float          accel_sum[6][3]; // 各位置静止窗口均值之和 (g, 含芯片当前偏移)
+
+    IMUCal_Stats_t stats;
+} IMUCal_t;
+
+// ================= 函数声明 =================
+
+/* 初始化 (不改动芯片), 默认开启在线陀螺零偏 */
+void   IMUCal_Init(IMUCal_t *cal, ICM42688_t *dev);
+void   IMUCal_SetStillness(IMUCal_t *cal, float gyro_dps, float accel_g);
+void   IMUCal_EnableGyroOnline(IMUCal_t *cal, uint8_t enable);
+
+/* 输入一批原始采样 (主循环中调用) */
+void   IMUCal_Update(IMUCal_t *cal, const ICM_RawData_t *samples, uint16_t n);
+
+/* 六面法: 摆好位置后调用 AccelCapture, 等 AccelDone 对应位置置位, 六个位置都完成后 Solve */
+void   IMUCal_AccelCapture(IMUCal_t *cal, IMUCal_Pos_t pos);
+uint8_t IMUCal_AccelDone(const IMUCal_t *cal);
+// 返回 0 成功, -1 位置未采全, -2 结果不合理 (摆放错误或传感器异常)
+int8_t IMUCal_AccelSolve(IMUCal_t *cal);
+
+/* 系数持久化 */
+void   IMUCal_Export(IMUCal_t *cal, IMUCal_Coef_t *out);
+// 校验后写入芯片, 返回 0 成功, -1 数据无效, -2 写入失败
+int8_t IMUCal_Load(IMUCal_t *cal, const IMUCal_Coef_t *in);
+// 把当前系数写入芯片
+int8_t IMUCal_Apply(IMUCal_t *cal);
+
+void   IMUCal_GetStats(const IMUCal_t *cal, IMUCal_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_CAL_H__ */
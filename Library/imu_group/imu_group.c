@@ -0,0 +1,235 @@
+#include "imu_group.h"
+#include <string.h> // for memset
+
+// ================= 内部静态辅助函数 =================
+
+// 三个数的中位数
+static inline int16_t IMUGroup_Median3(int16_t a, int16_t b, int16_t c) {
+    if (a > b) { int16_t t = a; a = b; b = t; }
+    if (b > c) b = c;
+    return (a > b) ? a : b;
+}
+
+// 放入对齐队列, 满了丢弃最旧的
+static void IMUGroup_Push(IMUGroup_t *grp, uint8_t i, const ICM_RawData_t *s, uint16_t n) {
+    for (uint16_t k = 0; k < n; k++) {
+        if (grp->q_count[i] == IMUGROUP_QUEUE) {
+            grp->q_head[i] = (grp->q_head[i] + 1) % IMUGROUP_QUEUE;
+            grp->q_count[i]--;
+            grp->stats.dropped[i]++;
+        }
+        grp->q[i][(grp->q_head[i] + grp->q_count[i]) % IMUGROUP_QUEUE] = s[k];
+        grp->q_count[i]++;
+    }
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化组 (不访问芯片)
+ */
+int8_t IMUGroup_Init(IMUGroup_t *grp, ICM42688_t *const devs[], uint8_t n) {
+    if (n == 0 || n > IMUGROUP_MAX_DEV) return -1;
+
+    memset(grp, 0, sizeof(*grp));
+    for (uint8_t i = 0; i < n; i++) grp->dev[i] = devs[i];
+    grp->n = n;
+    grp->all = (uint8_t)((1u << n) - 1);
+    return 0;
+}
+
+/**
+ * @brief 统一配置各片, 然后背靠背清空 FIFO 并锁存时间戳, 使各片的时间关联同时起步
+ */
+int8_t IMUGroup_Config(IMUGroup_t *grp, ICM_AccelRange_t accel_fs, ICM_GyroRange_t gyro_fs,
+                       ICM_ODR_t odr, uint8_t clkin) {
+    for (uint8_t i = 0; i < grp->n; i++) {
+        ICM42688_t *dev = grp->dev[i];
+
+        if (ICM42688_SetClockIn(dev, clkin) != 0) return -(int8_t)(i + 1);
+        if (ICM42688_SetAccelConfig(dev, accel_fs, odr) != 0) return -(int8_t)(i + 1);
+        if (ICM42688_SetGyroConfig(dev, gyro_fs, odr) != 0) return -(int8_t)(i + 1);
+        if (ICM42688_FIFO_Config(dev, ICM_FIFO_STREAM, 0) != 0) return -(int8_t)(i + 1);
+        ICM42688_TS_Reset(dev);
+    }
+    HAL_Delay(50); // 陀螺仪启动
+
+    // 两个循环各自紧凑执行, 各片之间只差一次 SPI 事务
+    for (uint8_t i = 0; i < grp->n; i++) ICM42688_FIFO_Flush(grp->dev[i]);
+    for (uint8_t i = 0; i < grp->n; i++) ICM42688_TS_Strobe(grp->dev[i]);
+
+    float rate = ICM42688_GetSampleRate(grp->dev[0]);
+    if (rate <= 0.0f) return -(int8_t)(IMUGROUP_MAX_DEV + 1); // ODR 无效, 不是某一片的错误
+    grp->period = (uint32_t)((float)ICM_TS_NOW_HZ / rate);
+    grp->sync_next = 0;
+    grp->sync_last = ICM_TS_NOW();
+    for (uint8_t i = 0; i < grp->n; i++) {
+        grp->q_head[i] = 0;
+        grp->q_count[i] = 0;
+        grp->phase[i] = 0;
+    }
+    grp->phase_valid = 0;
+    memset(&grp->stats, 0, sizeof(grp->stats));
+    return 0;
+}
+
+/**
+ * @brief 依次读取各片 FIFO, 到期时给其中一片做时间同步
+ * @note  单次 Poll 的 SPI 字节数上限: n x (3 + 1 + IMUGROUP_BURST x 16) + 一次同步 (约 10 字节)
+ */
+int8_t IMUGroup_Poll(IMUGroup_t *grp) {
+    ICM_RawData_t buf[IMUGROUP_BURST];
+    uint32_t start = DWT->CYCCNT;
+    uint32_t bytes = 0;
+    int8_t ret = 0;
+    uint32_t now = ICM_TS_NOW();
+    uint8_t sync = (now - grp->sync_last >= (uint32_t)(ICM_TS_NOW_HZ / 1000u) * IMUGROUP_SYNC_MS);
+
+    for (uint8_t i = 0; i < grp->n; i++) {
+        uint16_t got = 0;
+
+        if (ICM42688_FIFO_Read(grp->dev[i], buf, IMUGROUP_BURST, &got) != 0) {
+            grp->stats.errors[i]++;
+            ret = -1;
+            continue; // 该片本次不同步, 下次 Poll 再试
+        }
+        bytes += 3 + ((got > 0) ? 1 + got * ICM_FIFO_PKT3_LEN : 0);
+        IMUGroup_Push(grp, i, buf, got);
+
+        // 紧跟在该片 FIFO 读取之后锁存, 时间戳展开链不会断
+        if (sync && i == grp->sync_next) {
+            if (ICM42688_TS_Strobe(grp->dev[i]) == 0) bytes += 10;
+            grp->sync_next = (uint8_t)((grp->sync_next + 1) % grp->n);
+            grp->sync_last = now;
+        }
+    }
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    grp->stats.polls++;
+    grp->stats.bytes_last = bytes;
+    if (bytes > grp->stats.bytes_max) grp->stats.bytes_max = bytes;
+    grp->stats.cycles_last = cycles;
+    if (cycles > grp->stats.cycles_max) grp->stats.cycles_max = cycles;
+    return ret;
+}
+
+// 把相位差归到 (-P/2, P/2]
+static int32_t IMUGroup_WrapPhase(int32_t d, uint32_t period) {
+    int32_t p = (int32_t)period;
+    while (d > p / 2) d -= p;
+    while (d <= -p / 2) d += p;
+    return d;
+}
+
+/**
+ * @brief 对齐各片队首采样, 输出时间对齐的采样组
+ * @note  各片的采样时刻相对设备 0 有一个相位差 (上电先后决定, 可达一个周期), 先扣除
+ *        相位差再比较, 相差不到半个周期的归为一组. 相位差在完整的组上跟踪: 共用外部时钟时
+ *        保持不变; 各自内部时钟时随时钟偏差缓慢移动, 越过半个周期即错开一个采样 (产生一次不完整的组).
+ *        某片暂时没有数据时等待, 直到其他片积压超过 IMUGROUP_LAG_MAX
+ */
+uint16_t IMUGroup_GetSets(IMUGroup_t *grp, IMUGroup_Set_t *out, uint16_t max) {
+    uint16_t count = 0;
+
+    while (count < max) {
+        uint32_t t[IMUGROUP_MAX_DEV];
+        uint32_t a_min = 0;
+        uint8_t have = 0;
+        uint16_t backlog = 0;
+
+        for (uint8_t i = 0; i < grp->n; i++) {
+            if (grp->q_count[i] == 0) continue;
+
+            t[i] = ICM42688_TS_ToMcu(grp->dev[i], grp->q[i][grp->q_head[i]].timestamp);
+            if (grp->q_count[i] > backlog) backlog = grp->q_count[i];
+            have |= (uint8_t)(1u << i);
+        }
+        if (have == 0) break;
+        if (have != grp->all && backlog <= IMUGROUP_LAG_MAX) break;
+
+        // 第一次凑齐所有设备时测量相位差
+        if (!grp->phase_valid && have == grp->all) {
+            for (uint8_t i = 1; i < grp->n; i++) {
+                grp->phase[i] = IMUGroup_WrapPhase((int32_t)(t[i] - t[0]), grp->period);
+            }
+            grp->phase_valid = 1;
+        }
+
+        // 扣除相位差后的时间
+        uint32_t adj[IMUGROUP_MAX_DEV];
+        uint8_t first = 1;
+        for (uint8_t i = 0; i < grp->n; i++) {
+            if (!(have & (1u << i))) continue;
+
+            adj[i] = t[i] - (uint32_t)grp->phase[i];
+            if (first || (int32_t)(adj[i] - a_min) < 0) a_min = adj[i];
+            first = 0;
+        }
+
+        IMUGroup_Set_t *set = &out[count];
+        uint32_t t_lo = 0, t_hi = 0;
+        uint32_t acc = 0;
+        uint8_t members = 0;
+
+        set->valid = 0;
+        for (uint8_t i = 0; i < grp->n; i++) {
+            if (!(have & (1u << i))) continue;
+            if (adj[i] - a_min >= grp->period / 2) continue; // 属于下一组
+
+            set->s[i] = grp->q[i][grp->q_head[i]];
+            set->valid |= (uint8_t)(1u << i);
+            grp->q_head[i] = (grp->q_head[i] + 1) % IMUGROUP_QUEUE;
+            grp->q_count[i]--;
+
+            if (members == 0 || (int32_t)(t[i] - t_lo) < 0) t_lo = t[i];
+            if (members == 0 || (int32_t)(t[i] - t_hi) > 0) t_hi = t[i];
+            acc += t[i] - a_min;
+            members++;
+        }
+
+        // 完整的组: 跟踪相位差
+        if (set->valid == grp->all) {
+            for (uint8_t i = 1; i < grp->n; i++) {
+                int32_t e = (int32_t)(t[i] - t[0]) - grp->phase[i];
+                grp->phase[i] = IMUGroup_WrapPhase(grp->phase[i] + IMUGroup_WrapPhase(e, grp->period) / 8,
+                                                   grp->period);
+            }
+        } else {
+            grp->stats.partial++;
+        }
+
+        set->time = a_min + acc / members;
+        if (t_hi - t_lo > grp->stats.skew_max) grp->stats.skew_max = t_hi - t_lo;
+        grp->stats.sets++;
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief 组内表决 (原始 LSB, 要求各片量程相同)
+ */
+uint8_t IMUGroup_Vote(const IMUGroup_t *grp, const IMUGroup_Set_t *set, ICM_RawData_t *out) {
+    const int16_t *v[IMUGROUP_MAX_DEV];
+    int16_t *o = (int16_t *)out;
+    uint8_t n = 0;
+
+    for (uint8_t i = 0; i < grp->n; i++) {
+        if (!(set->valid & (1u << i))) continue;
+        if (n == 0) out->timestamp = set->s[i].timestamp; // 取第一片的芯片时间
+        v[n++] = (const int16_t *)&set->s[i];
+    }
+    if (n == 0) return 0;
+
+    // accel x/y/z, gyro x/y/z, temp 连续存放 (见 ICM_RawData_t)
+    for (uint8_t a = 0; a < 7; a++) {
+        if (n >= 3) o[a] = IMUGroup_Median3(v[0][a], v[1][a], v[2][a]);
+        else if (n == 2) o[a] = (int16_t)(((int32_t)v[0][a] + v[1][a]) / 2);
+        else o[a] = v[0][a];
+    }
+    return n;
+}
+
+void IMUGroup_GetStats(const IMUGroup_t *grp, IMUGroup_Stats_t *stats) {
+    *stats = grp->stats;
+}
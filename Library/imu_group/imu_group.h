@@ -0,0 +1,110 @@
+#ifndef __IMU_GROUP_H__
+#define __IMU_GROUP_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "icm42688.h"
+
+/*
+ * 多 IMU 组 (冗余设计: 2 ~ 3 片 ICM42688 共用一条 SPI, 各自片选).
+ *
+ * 1. 同一配置: IMUGroup_Config 对每片写入相同的量程 / ODR / FIFO 设置.
+ * 2. 同频: 可选外部时钟 (各片引脚 9 接同一个 32.768kHz 源, 如 MCO1 输出 LSE),
+ *    ODR 完全同频, 组内相位差恒定; 不接外部时钟时由时间关联跟踪各片的时钟偏差.
+ * 3. 定时读取: IMUGroup_Poll 按固定顺序依次突发读取各片 FIFO (每片最多 IMUGROUP_BURST 个包),
+ *    每次 Poll 只给一片做时间同步, 单次 Poll 的 SPI 字节数有上限.
+ * 4. 对齐: 各片采样的芯片时间换算到 MCU 时间, 扣除各片固定的相位差后,
+ *    相差不到半个采样周期的归为一组输出.
+ *    某片掉线 / 落后太多时不阻塞其他片, 输出不完整的组 (valid 中对应位为 0).
+ */
+
+// ================= 配置区域 =================
+
+/* 组内最多设备数 */
+#define IMUGROUP_MAX_DEV   3
+
+/* 每片的对齐队列长度 (采样) */
+#define IMUGROUP_QUEUE     64
+
+/* 每次 Poll 每片最多读出的包数 (<= ICM_FIFO_BURST_MAX) */
+#define IMUGROUP_BURST     ICM_FIFO_BURST_MAX
+
+/* 某片没有数据而其他片积压超过该值时, 不再等待, 输出不完整的组 */
+#define IMUGROUP_LAG_MAX   8
+
+/* 时间同步间隔 (ms), 各片轮流进行 */
+#define IMUGROUP_SYNC_MS   100
+
+// ================= 数据结构 =================
+
+/* 一组时间对齐的采样 */
+typedef struct {
+    uint32_t      time;                    // 组内平均 MCU 时间 (ICM_TS_NOW 计数)
+    uint8_t       valid;                   // bit i: 设备 i 有数据
+    ICM_RawData_t s[IMUGROUP_MAX_DEV];
+} IMUGroup_Set_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t polls;
+    uint32_t sets;                         // 输出的组数
+    uint32_t partial;                      // 其中不完整的组
+    uint32_t dropped[IMUGROUP_MAX_DEV];    // 队列满丢弃的采样
+    uint32_t errors[IMUGROUP_MAX_DEV];     // SPI 读取失败次数
+    uint32_t bytes_last;                   // 最近一次 Poll 的 SPI 字节数
+    uint32_t bytes_max;
+    uint32_t cycles_last;                  // 最近一次 Poll 的耗时 (CPU 周期)
+    uint32_t cycles_max;
+    uint32_t skew_max;                     // 组内采样时刻的最大差 (MCU 计数, 含相位差)
+} IMUGroup_Stats_t;
+
+typedef struct {
+    ICM42688_t   *dev[IMUGROUP_MAX_DEV];
+    uint8_t       n;
+    uint8_t       all;                     // 全部设备的 valid 位
+    uint32_t      period;                  // 采样周期 (MCU 计数)
+    uint8_t       sync_next;               // 下一个做时间同步的设备
+    uint32_t      sync_last;               // 上一次时间同步的 MCU 时间
+    int32_t       phase[IMUGROUP_MAX_DEV]; // 各片采样时刻相对设备 0 的相位差 (MCU 计数)
+    uint8_t       phase_valid;
+
+    // 对齐队列
+    ICM_RawData_t q[IMUGROUP_MAX_DEV][IMUGROUP_QUEUE];
+    uint16_t      q_head[IMUGROUP_MAX_DEV];
+    uint16_t      q_count[IMUGROUP_MAX_DEV];
+
+    IMUGroup_Stats_t stats;
+} IMUGroup_t;
+
+// ================= 函数声明 =================
+
+/* devs: 已完成 ICM42688_Init (或 InitOnBus) 的设备, n <= IMUGROUP_MAX_DEV */
+int8_t   IMUGroup_Init(IMUGroup_t *grp, ICM42688_t *const devs[], uint8_t n);
+
+/**
+ * @brief 统一配置并开始采集
+ * @param clkin 1: 各片使用引脚 9 外部时钟 (需先输出时钟), 0: 各自内部时钟
+ * @return 0 成功, -1 ~ -n: 第 -ret 片 (从 1 开始) 配置失败, -(IMUGROUP_MAX_DEV + 1): ODR 无效 (采样率为 0)
+ */
+int8_t   IMUGroup_Config(IMUGroup_t *grp, ICM_AccelRange_t accel_fs, ICM_GyroRange_t gyro_fs,
+                         ICM_ODR_t odr, uint8_t clkin);
+
+/* 定时调用 (间隔 < IMUGROUP_BURST 个采样周期): 依次读取各片 FIFO */
+int8_t   IMUGroup_Poll(IMUGroup_t *grp);
+
+/* 取出对齐好的采样组, 返回组数 */
+uint16_t IMUGroup_GetSets(IMUGroup_t *grp, IMUGroup_Set_t *out, uint16_t max);
+
+/* 表决: 三片取逐轴中位数, 两片取平均, 一片直接复制; 返回参与的设备数 */
+uint8_t  IMUGroup_Vote(const IMUGroup_t *grp, const IMUGroup_Set_t *set, ICM_RawData_t *out);
+
+void     IMUGroup_GetStats(const IMUGroup_t *grp, IMUGroup_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMU_GROUP_H__ */
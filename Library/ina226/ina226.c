@@ -1,5 +1,6 @@
 #include "ina226.h"
 #include <math.h> // 需要用到 ceil 或简单的浮点运算
+#include <string.h> // for memset
 
 /* --- 内部辅助：写 16位寄存器 (处理大端序) --- */
 static HAL_StatusTypeDef INA226_WriteReg(INA226_HandleTypeDef *hdev, uint8_t reg, uint16_t value) {
@@ -20,39 +21,51 @@ static HAL_StatusTypeDef INA226_ReadReg(INA226_HandleTypeDef *hdev, uint8_t reg,
     return HAL_OK;
 }
 
-/* --- 内部辅助：校准计算 --- */
-static void INA226_Calibrate(INA226_HandleTypeDef *hdev) {
-    // 1. 计算 Current_LSB
-    // 公式: Current_LSB = MaxCurrent / 32768
-    // 为了方便阅读和计算，通常我们会把 LSB 向上取整到一个整洁的数字 (如 0.1mA, 1mA)
-    // 这里为了通用性，直接使用精确计算值，或者稍微放大一点以避免溢出
-    hdev->Current_LSB = hdev->MaxCurrent_Amp / 32768.0f;
-    
-    // 如果算出来太小，为了精度可以设个下限，比如 0.0001 (100uA)
-    // 这里简单处理，直接用算出的值。
+/* --- 内部辅助：校准计算 (整数, 精确舍入) --- */
+static HAL_StatusTypeDef INA226_Calibrate(INA226_HandleTypeDef *hdev, uint32_t r_shunt_uohm, uint32_t i_max_ma) {
+    // 1. 理论 Current_LSB = MaxCurrent / 32768 (nA), 向上取整保证满量程不溢出
+    uint64_t lsb_na = ((uint64_t)i_max_ma * 1000000u + 32767u) / 32768u;
 
-    // 2. 计算 Calibration Register (CAL)
-    // 公式: CAL = 0.00512 / (Current_LSB * R_Shunt)
-    // 注意: 0.00512 是芯片内部固定的常数
-    float cal_float = 0.00512f / (hdev->Current_LSB * hdev->ShuntResistor_Ohm);
-    
-    uint16_t cal_reg = (uint16_t)cal_float;
-    
-    // 3. 写入校准寄存器
-    INA226_WriteReg(hdev, INA226_REG_CALIBRATION, cal_reg);
-    
-    // 4. 计算 Power_LSB (固定是 Current_LSB 的 25 倍)
+    // 2. CAL = 0.00512 / (Current_LSB * R_Shunt) = 5.12e12 / (lsb_nA * R_uOhm), 四舍五入
+    //    bit15 保留, 上限 0x7FFF
+    uint64_t den = lsb_na * r_shunt_uohm;
+    if (den == 0) return HAL_ERROR;
+    uint64_t cal = (5120000000000ull + den / 2) / den;
+    if (cal == 0) cal = 1;
+    if (cal > 0x7FFF) cal = 0x7FFF;
+
+    // 3. 由 CAL 反推芯片实际使用的电流 LSB: 5.12e-3 / (CAL * R) A = 5.12e9 / (CAL * R_uOhm) uA,
+    //    舍入误差不再带进读数. CAL 向上舍入时满量程可能多出 1 个计数, 此时减 1
+    uint64_t lsb_q16;
+    while (1) {
+        uint64_t d = cal * r_shunt_uohm;
+        lsb_q16 = ((5120000000ull << 16) + d / 2) / d;
+        if (cal == 1 || (uint64_t)i_max_ma * 1000u * 65536u <= 32767u * lsb_q16) break;
+        cal--;
+    }
+
+    // 4. 写入校准寄存器; Power_LSB 固定是 Current_LSB 的 25 倍
+    if (INA226_WriteReg(hdev, INA226_REG_CALIBRATION, (uint16_t)cal) != HAL_OK) return HAL_ERROR;
+    hdev->Calibration = (uint16_t)cal;
+    hdev->ShuntResistor_uOhm = r_shunt_uohm;
+    hdev->CurrentLSB_uA_Q16 = (uint32_t)lsb_q16;
+#if INA226_USE_FLOAT
+    hdev->Current_LSB = hdev->CurrentLSB_uA_Q16 / (65536.0f * 1000000.0f);
     hdev->Power_LSB = hdev->Current_LSB * 25.0f;
+#endif
+    return HAL_OK;
 }
 
 /**
- * @brief  初始化 INA226
+ * @brief  初始化 INA226 (整数参数)
  */
-HAL_StatusTypeDef INA226_Init(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, uint16_t addr, float r_shunt, float i_max) {
+HAL_StatusTypeDef INA226_InitInt(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, uint16_t addr,
+                                 uint32_t r_shunt_uohm, uint32_t i_max_ma) {
     hdev->hi2c = hi2c;
     hdev->Addr = addr;
-    hdev->ShuntResistor_Ohm = r_shunt;
-    hdev->MaxCurrent_Amp = i_max;
+    hdev->ItActive = 0;
+    hdev->ItBusy = 0;
+    hdev->AlertCallback = NULL;
     
     // 1. 检查设备ID (可选，寄存器 FE 和 FF)
     if (HAL_I2C_IsDeviceReady(hdev->hi2c, hdev->Addr, 3, 100) != HAL_OK) {
@@ -66,11 +79,22 @@ HAL_StatusTypeDef INA226_Init(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2
     
     // 写入默认配置 (平均次数等)
     if (INA226_WriteReg(hdev, INA226_REG_CONFIG, INA226_CONFIG_DEFAULT) != HAL_OK) return HAL_ERROR;
+    hdev->Config = INA226_CONFIG_DEFAULT;
+    hdev->MaskEnable = 0x0000;
 
     // 3. 执行校准 (这是读出正确电流的关键)
-    INA226_Calibrate(hdev);
+    return INA226_Calibrate(hdev, r_shunt_uohm, i_max_ma);
+}
 
-    return HAL_OK;
+#if INA226_USE_FLOAT
+/**
+ * @brief  初始化 INA226
+ */
+HAL_StatusTypeDef INA226_Init(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, uint16_t addr, float r_shunt, float i_max) {
+    hdev->ShuntResistor_Ohm = r_shunt;
+    hdev->MaxCurrent_Amp = i_max;
+
+    return INA226_InitInt(hdev, hi2c, addr, (uint32_t)(r_shunt * 1000000.0f + 0.5f), (uint32_t)(i_max * 1000.0f + 0.5f));
 }
 
 /**
@@ -115,10 +139,354 @@ HAL_StatusTypeDef INA226_ReadAll(INA226_HandleTypeDef *hdev) {
 
     return HAL_OK;
 }
+#endif /* INA226_USE_FLOAT */
+
+/**
+ * @brief  整数读取: 四个寄存器换算为微单位
+ */
+HAL_StatusTypeDef INA226_ReadAllInt(INA226_HandleTypeDef *hdev) {
+    static const uint8_t regs[4] = {
+        INA226_REG_BUS_VOLTAGE, INA226_REG_CURRENT, INA226_REG_POWER, INA226_REG_SHUNT_VOLTAGE
+    };
+
+    for (uint8_t i = 0; i < 4; i++) {
+        if (INA226_ReadReg(hdev, regs[i], &hdev->Raw[regs[i]]) != HAL_OK) return HAL_ERROR;
+    }
+    INA226_ConvertInt(hdev, INA226_READ_ALL);
+    return HAL_OK;
+}
+
+/**
+ * @brief  Raw[] 中的寄存器换算为微单位
+ * @note   总线 1.25mV/bit = 1250uV, 分流 2.5uV/bit = 2500nV (用 nV 保持精确);
+ *         电流 / 功率乘 Q16 的 LSB 后四舍五入, 32x32->64 乘法, 无除法
+ */
+void INA226_ConvertInt(INA226_HandleTypeDef *hdev, uint8_t regs) {
+    uint32_t lsb = hdev->CurrentLSB_uA_Q16;
+
+    if (regs & INA226_READ_BUS)   hdev->Bus_uV = (int32_t)hdev->Raw[INA226_REG_BUS_VOLTAGE] * 1250;
+    if (regs & INA226_READ_SHUNT) hdev->Shunt_nV = (int16_t)hdev->Raw[INA226_REG_SHUNT_VOLTAGE] * 2500;
+    if (regs & INA226_READ_CURRENT) {
+        int64_t x = (int64_t)(int16_t)hdev->Raw[INA226_REG_CURRENT] * lsb;
+        hdev->Current_uA = (int32_t)((x + 0x8000) >> 16);
+    }
+    if (regs & INA226_READ_POWER) {
+        uint64_t x = (uint64_t)hdev->Raw[INA226_REG_POWER] * lsb * 25u;
+        hdev->Power_uW = (uint32_t)((x + 0x8000) >> 16);
+    }
+}
 
 /**
  * @brief  软件复位
  */
 HAL_StatusTypeDef INA226_Reset(INA226_HandleTypeDef *hdev) {
-    return INA226_WriteReg(hdev, INA226_REG_CONFIG, 0x8000);
+    if (INA226_WriteReg(hdev, INA226_REG_CONFIG, 0x8000) != HAL_OK) return HAL_ERROR;
+    hdev->Config = 0x4127; // 上电默认: AVG=1, 1.1ms, 连续模式
+    hdev->MaskEnable = 0x0000;
+    return HAL_OK;
+}
+
+/* --- 配置 --- */
+
+// 平均次数与转换时间 (us), 按配置字段取值索引
+static const uint16_t s_avg_count[8] = { 1, 4, 16, 64, 128, 256, 512, 1024 };
+static const uint16_t s_conv_us[8]   = { 140, 204, 332, 588, 1100, 2116, 4156, 8244 };
+
+/**
+ * @brief  设置平均次数、转换时间与工作模式
+ * @note   配置寄存器: bit14 固定为 1 | AVG[11:9] | VBUSCT[8:6] | VSHCT[5:3] | MODE[2:0]
+ */
+HAL_StatusTypeDef INA226_SetConfig(INA226_HandleTypeDef *hdev, INA226_Avg_t avg, INA226_ConvTime_t vbus_ct,
+                                   INA226_ConvTime_t vsh_ct, INA226_Mode_t mode) {
+    if (hdev->ItActive) return HAL_BUSY;
+
+    uint16_t cfg = 0x4000 | ((avg & 0x07) << 9) | ((vbus_ct & 0x07) << 6) | ((vsh_ct & 0x07) << 3) | (mode & 0x07);
+    if (INA226_WriteReg(hdev, INA226_REG_CONFIG, cfg) != HAL_OK) return HAL_ERROR;
+
+    hdev->Config = cfg;
+    return HAL_OK;
+}
+
+/**
+ * @brief  启动一次触发转换
+ */
+HAL_StatusTypeDef INA226_Trigger(INA226_HandleTypeDef *hdev) {
+    return INA226_WriteReg(hdev, INA226_REG_CONFIG, hdev->Config);
+}
+
+/**
+ * @brief  一次完整转换的时间: 平均次数 x (开启的 VBUS 转换时间 + VSHUNT 转换时间)
+ */
+uint32_t INA226_GetUpdatePeriod_us(const INA226_HandleTypeDef *hdev) {
+    uint16_t cfg = hdev->Config;
+    uint8_t mode = cfg & 0x07;
+    uint32_t t = 0;
+
+    if (mode & 0x01) t += s_conv_us[(cfg >> 3) & 0x07]; // 分流电压
+    if (mode & 0x02) t += s_conv_us[(cfg >> 6) & 0x07]; // 总线电压
+    return t * s_avg_count[(cfg >> 9) & 0x07];
+}
+
+/* --- 超限报警 --- */
+
+// 有符号除法, 四舍五入
+static int64_t INA226_DivRound(int64_t n, int64_t d) {
+    return (n >= 0) ? (n + d / 2) / d : (n - d / 2) / d;
+}
+
+/**
+ * @brief  设置超限报警功能与限值 (整数, 限值单位 uA / uV / uW)
+ * @note   限值寄存器格式与被比较的寄存器相同: 分流电压 2.5uV/bit (有符号), 总线电压 1.25mV/bit,
+ *         功率为功率寄存器的 LSB. 先写限值再开报警, 避免用旧限值误触发
+ */
+HAL_StatusTypeDef INA226_SetAlertInt(INA226_HandleTypeDef *hdev, INA226_AlertFunc_t func, int32_t limit, uint8_t latch) {
+    int64_t raw = 0;
+    int64_t lo = 0, hi = 65535;
+
+    if (hdev->ItActive) return HAL_BUSY;
+
+    switch (func) {
+    case INA226_ALERT_SHUNT_OVER:
+    case INA226_ALERT_SHUNT_UNDER:
+        // 分流电压 (uV) = I (uA) x R (uOhm) / 1e6, 再除以 2.5uV
+        raw = INA226_DivRound((int64_t)limit * hdev->ShuntResistor_uOhm * 2, 5000000);
+        lo = -32768;
+        hi = 32767;
+        break;
+    case INA226_ALERT_BUS_OVER:
+    case INA226_ALERT_BUS_UNDER:
+        raw = INA226_DivRound(limit, 1250);
+        hi = 32767;
+        break;
+    case INA226_ALERT_POWER_OVER:
+        // 功率 LSB = 25 x 电流 LSB (uA, Q16)
+        raw = INA226_DivRound((int64_t)limit << 16, (int64_t)hdev->CurrentLSB_uA_Q16 * 25);
+        break;
+    case INA226_ALERT_NONE:
+        break;
+    default:
+        return HAL_ERROR;
+    }
+
+    if (func != INA226_ALERT_NONE) {
+        if (raw < lo) raw = lo;
+        if (raw > hi) raw = hi;
+        if (INA226_WriteReg(hdev, INA226_REG_ALERT_LIMIT, (uint16_t)raw) != HAL_OK) return HAL_ERROR;
+    }
+
+    uint16_t me = (hdev->MaskEnable & ~(INA226_ALERT_FUNC_MASK | INA226_MASK_LEN)) | (uint16_t)func;
+    if (latch || (me & INA226_MASK_CNVR)) me |= INA226_MASK_LEN;
+    if (INA226_WriteReg(hdev, INA226_REG_MASK_ENABLE, me) != HAL_OK) return HAL_ERROR;
+
+    hdev->MaskEnable = me;
+    return HAL_OK;
+}
+
+#if INA226_USE_FLOAT
+/**
+ * @brief  设置超限报警功能与限值 (A / V / W)
+ */
+HAL_StatusTypeDef INA226_SetAlert(INA226_HandleTypeDef *hdev, INA226_AlertFunc_t func, float limit, uint8_t latch) {
+    float micro = limit * 1000000.0f;
+
+    if (micro > 2147483520.0f) micro = 2147483520.0f;
+    if (micro < -2147483520.0f) micro = -2147483520.0f;
+    return INA226_SetAlertInt(hdev, func, (int32_t)((micro >= 0.0f) ? (micro + 0.5f) : (micro - 0.5f)), latch);
+}
+#endif
+
+/**
+ * @brief  读 Mask/Enable, 清除锁存的报警
+ */
+HAL_StatusTypeDef INA226_ClearAlert(INA226_HandleTypeDef *hdev, uint16_t *flags) {
+    uint16_t val = 0;
+
+    if (INA226_ReadReg(hdev, INA226_REG_MASK_ENABLE, &val) != HAL_OK) return HAL_ERROR;
+    if (flags != NULL) *flags = val;
+    return HAL_OK;
+}
+
+/* --- 中断采集 --- */
+
+static void INA226_IT_Begin(INA226_HandleTypeDef *hdev);
+
+/* --- 内部辅助：启动读取一个寄存器 (中断 / DMA) --- */
+static HAL_StatusTypeDef INA226_IT_ReadReg(INA226_HandleTypeDef *hdev, uint8_t reg) {
+    hdev->ItReg = reg;
+#if INA226_IT_USE_DMA
+    return HAL_I2C_Mem_Read_DMA(hdev->hi2c, hdev->Addr, reg, I2C_MEMADD_SIZE_8BIT, hdev->ItBuf, 2);
+#else
+    return HAL_I2C_Mem_Read_IT(hdev->hi2c, hdev->Addr, reg, I2C_MEMADD_SIZE_8BIT, hdev->ItBuf, 2);
+#endif
+}
+
+/* --- 内部辅助：换算本次读到的寄存器 --- */
+static void INA226_IT_Convert(INA226_HandleTypeDef *hdev) {
+    uint8_t done = hdev->ItDone;
+
+    INA226_ConvertInt(hdev, done);
+#if INA226_USE_FLOAT
+    if (done & INA226_READ_BUS)     hdev->Voltage_V = hdev->Raw[INA226_REG_BUS_VOLTAGE] * 0.00125f;
+    if (done & INA226_READ_CURRENT) hdev->Current_A = (int16_t)hdev->Raw[INA226_REG_CURRENT] * hdev->Current_LSB;
+    if (done & INA226_READ_POWER)   hdev->Power_W = hdev->Raw[INA226_REG_POWER] * hdev->Power_LSB;
+    if (done & INA226_READ_SHUNT)   hdev->ShuntVoltage_mV = (int16_t)hdev->Raw[INA226_REG_SHUNT_VOLTAGE] * 0.0025f;
+#endif
+}
+
+/* --- 内部辅助：一轮读取结束, 读取期间 ALERT 又触发过则立即开始下一轮 --- */
+static void INA226_IT_Finish(INA226_HandleTypeDef *hdev) {
+    // 检查挂起标志与清 busy 之间不能被 EXTI 打断, 否则这次转换会丢失
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (!hdev->ItPending || !hdev->ItActive) {
+        hdev->ItBusy = 0;
+        __set_PRIMASK(primask);
+        return;
+    }
+    hdev->ItPending = 0;
+    hdev->ItTime = hdev->ItPendingTime;
+    __set_PRIMASK(primask);
+
+    INA226_IT_Begin(hdev);
+}
+
+/* --- 内部辅助：开始一轮读取, 先读 Mask/Enable (清除 CVRF, 释放 ALERT) --- */
+static void INA226_IT_Begin(INA226_HandleTypeDef *hdev) {
+    hdev->ItDone = 0;
+    if (INA226_IT_ReadReg(hdev, INA226_REG_MASK_ENABLE) != HAL_OK) {
+        hdev->ItStats.Errors++;
+        INA226_IT_Finish(hdev);
+    }
+}
+
+/**
+ * @brief  启动 ALERT 转换完成中断采集
+ */
+HAL_StatusTypeDef INA226_IT_Start(INA226_HandleTypeDef *hdev, uint8_t regs, INA226_Callback cb) {
+    uint16_t mask = 0;
+
+    regs &= INA226_READ_ALL;
+    if (regs == 0 || hdev->ItActive) return HAL_ERROR;
+
+    hdev->ItRegs = regs;
+    hdev->ItCallback = cb;
+    hdev->ItPending = 0;
+    memset(&hdev->ItStats, 0, sizeof(hdev->ItStats));
+
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+    // 使能 DWT 周期计数器, 默认时间戳用它记录 ALERT 时刻
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    // CNVR: 每次转换完成拉低 ALERT (低有效), 读 Mask/Enable 后释放; 已设置的超限报警保留并改为锁存
+    uint16_t me = hdev->MaskEnable | INA226_MASK_CNVR;
+    if (me & INA226_ALERT_FUNC_MASK) me |= INA226_MASK_LEN;
+    if (INA226_WriteReg(hdev, INA226_REG_MASK_ENABLE, me) != HAL_OK) return HAL_ERROR;
+    hdev->MaskEnable = me;
+
+    // 先置 busy 再读一次 Mask/Enable 清除已有的 CVRF: 这期间完成的转换记为挂起, 不会漏掉
+    hdev->ItBusy = 1;
+    hdev->ItActive = 1;
+    if (INA226_ReadReg(hdev, INA226_REG_MASK_ENABLE, &mask) != HAL_OK) {
+        hdev->ItActive = 0;
+        hdev->ItBusy = 0;
+        return HAL_ERROR;
+    }
+    INA226_IT_Finish(hdev);
+    return HAL_OK;
+}
+
+void INA226_IT_SetAlertCallback(INA226_HandleTypeDef *hdev, INA226_AlertCallback cb) {
+    hdev->AlertCallback = cb;
+}
+
+/**
+ * @brief  停止中断采集, 关闭 ALERT 转换完成输出
+ * @retval HAL_TIMEOUT: 10ms 内没有等到最后一轮读完 (总线卡住或 I2C 回调没有转发), 未关闭转换完成输出
+ */
+HAL_StatusTypeDef INA226_IT_Stop(INA226_HandleTypeDef *hdev) {
+    uint32_t start = HAL_GetTick();
+
+    hdev->ItActive = 0;
+    while (hdev->ItBusy) { // 等最后一轮读完
+        if (HAL_GetTick() - start > 10) {
+            hdev->ItBusy = 0; // 之后迟到的回调直接忽略
+            return HAL_TIMEOUT;
+        }
+    }
+
+    // 只关闭转换完成输出, 超限报警继续有效
+    hdev->MaskEnable &= ~INA226_MASK_CNVR;
+    return INA226_WriteReg(hdev, INA226_REG_MASK_ENABLE, hdev->MaskEnable);
+}
+
+/**
+ * @brief  ALERT 下降沿: 开始读取本次转换结果
+ */
+void INA226_IT_EXTI_Callback(INA226_HandleTypeDef *hdev) {
+    uint32_t now = INA226_TIMESTAMP();
+
+    if (!hdev->ItActive) return;
+
+    if (hdev->ItBusy) {
+        // Mask/Enable 已读过, ALERT 再次拉低说明又完成了一次转换: 本轮读完后接着读
+        hdev->ItPendingTime = now;
+        hdev->ItPending = 1;
+        hdev->ItStats.Late++;
+        return;
+    }
+    hdev->ItBusy = 1;
+    hdev->ItTime = now;
+    INA226_IT_Begin(hdev);
+}
+
+/**
+ * @brief  I2C 读取完成/出错: 依次读取所选寄存器, 全部读完后换算并回调
+ */
+void INA226_IT_I2C_Callback(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, int8_t status) {
+    if (hi2c != hdev->hi2c || !hdev->ItBusy) return;
+
+    if (status != 0) {
+        hdev->ItStats.Errors++;
+        INA226_IT_Finish(hdev);
+        return;
+    }
+
+    uint8_t reg = hdev->ItReg;
+    hdev->Raw[reg] = (hdev->ItBuf[0] << 8) | hdev->ItBuf[1];
+
+    if (reg == INA226_REG_MASK_ENABLE) {
+        uint16_t flags = hdev->Raw[reg];
+
+        if (flags & INA226_MASK_AFF) {
+            hdev->ItStats.Alerts++;
+            if (hdev->AlertCallback != NULL) hdev->AlertCallback(hdev, flags);
+        }
+        if (!(flags & INA226_MASK_CVRF)) {
+            if (!(flags & INA226_MASK_AFF)) hdev->ItStats.Spurious++;
+            INA226_IT_Finish(hdev);
+            return;
+        }
+    } else {
+        hdev->ItDone |= 1u << reg;
+    }
+
+    // 下一个未读的寄存器 (按地址从小到大)
+    uint8_t left = hdev->ItRegs & ~hdev->ItDone;
+    if (left) {
+        uint8_t next = INA226_REG_SHUNT_VOLTAGE;
+        while (!(left & (1u << next))) next++;
+
+        if (INA226_IT_ReadReg(hdev, next) != HAL_OK) {
+            hdev->ItStats.Errors++;
+            INA226_IT_Finish(hdev);
+        }
+        return;
+    }
+
+    INA226_IT_Convert(hdev);
+    hdev->ItStats.Conversions++;
+    if (hdev->ItCallback != NULL) hdev->ItCallback(hdev);
+    INA226_IT_Finish(hdev);
 }
@@ -24,11 +24,116 @@ extern "C" {
 // 0x4000(Reset) | 0x0400(AVG=16) | 0x01C0(VBUS=1.1ms) | 0x0038(VSH=1.1ms) | 0x0007(Cont V+I)
 #define INA226_CONFIG_DEFAULT    0x4527 
 
-/* --- 对象句柄 --- */
+/* 浮点接口: 1=保留 (物理量为 float), 0=只用整数路径 (无 FPU 的 M0+ 等), 句柄与代码中不再有浮点 */
+#ifndef INA226_USE_FLOAT
+#define INA226_USE_FLOAT         1
+#endif
+
+/* ALERT 时刻的时间戳 (中断采集记录在 ItTime 中): M3 及以上默认 DWT 周期计数器,
+ * M0/M0+ 没有 DWT, 默认 HAL_GetTick (1ms); 也可以换成 32 位定时器, 例如 (TIM2->CNT) 与 1000000u */
+#ifndef INA226_TIMESTAMP
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+#define INA226_TIMESTAMP()       (DWT->CYCCNT)
+#define INA226_TIMESTAMP_HZ      (SystemCoreClock)
+#else
+#define INA226_TIMESTAMP()       HAL_GetTick()
+#define INA226_TIMESTAMP_HZ      1000u
+#endif
+#endif
+
+/* --- 配置寄存器字段 (INA226_SetConfig) --- */
+// 平均次数
+typedef enum {
+    INA226_AVG_1 = 0,
+    INA226_AVG_4,
+    INA226_AVG_16,
+    INA226_AVG_64,
+    INA226_AVG_128,
+    INA226_AVG_256,
+    INA226_AVG_512,
+    INA226_AVG_1024
+} INA226_Avg_t;
+
+// 单次转换时间 (VBUS / VSHUNT 各自设置)
+typedef enum {
+    INA226_CT_140US = 0,
+    INA226_CT_204US,
+    INA226_CT_332US,
+    INA226_CT_588US,
+    INA226_CT_1100US,
+    INA226_CT_2116US,
+    INA226_CT_4156US,
+    INA226_CT_8244US
+} INA226_ConvTime_t;
+
+// 工作模式: 触发模式每次写配置寄存器 (INA226_Trigger) 转换一次后停止
+typedef enum {
+    INA226_MODE_POWER_DOWN     = 0,
+    INA226_MODE_SHUNT_TRIG     = 1,
+    INA226_MODE_BUS_TRIG       = 2,
+    INA226_MODE_SHUNT_BUS_TRIG = 3,
+    INA226_MODE_SHUNT_CONT     = 5,
+    INA226_MODE_BUS_CONT       = 6,
+    INA226_MODE_SHUNT_BUS_CONT = 7
+} INA226_Mode_t;
+
+/* --- Mask/Enable 寄存器位 --- */
+#define INA226_MASK_SOL          0x8000  // 分流电压超上限
+#define INA226_MASK_SUL          0x4000  // 分流电压低于下限
+#define INA226_MASK_BOL          0x2000  // 总线电压超上限
+#define INA226_MASK_BUL          0x1000  // 总线电压低于下限
+#define INA226_MASK_POL          0x0800  // 功率超上限
+#define INA226_ALERT_FUNC_MASK   0xF800
+#define INA226_MASK_CNVR         0x0400  // 转换完成时拉低 ALERT
+#define INA226_MASK_AFF          0x0010  // 报警功能标志
+#define INA226_MASK_CVRF         0x0008  // 转换完成标志 (读 Mask/Enable 时清除)
+#define INA226_MASK_OVF          0x0004  // 功率/电流计算溢出
+#define INA226_MASK_APOL         0x0002  // ALERT 高电平有效 (默认低有效, 开漏)
+#define INA226_MASK_LEN          0x0001  // 报警锁存
+
+/* 超限报警功能: 同一时间只能启用一种, 比较的是平均后的转换结果 */
+typedef enum {
+    INA226_ALERT_NONE        = 0,
+    INA226_ALERT_SHUNT_OVER  = INA226_MASK_SOL,  // 限值: 电流 (A), 按分流电阻换算成分流电压
+    INA226_ALERT_SHUNT_UNDER = INA226_MASK_SUL,  // 限值: 电流 (A), 可为负 (反向电流)
+    INA226_ALERT_BUS_OVER    = INA226_MASK_BOL,  // 限值: 总线电压 (V)
+    INA226_ALERT_BUS_UNDER   = INA226_MASK_BUL,  // 限值: 总线电压 (V)
+    INA226_ALERT_POWER_OVER  = INA226_MASK_POL   // 限值: 功率 (W)
+} INA226_AlertFunc_t;
+
+/* --- 中断采集: 每次转换读取的寄存器 (按寄存器地址取位, 可组合) --- */
+#define INA226_READ_SHUNT        (1u << INA226_REG_SHUNT_VOLTAGE)
+#define INA226_READ_BUS          (1u << INA226_REG_BUS_VOLTAGE)
+#define INA226_READ_POWER        (1u << INA226_REG_POWER)
+#define INA226_READ_CURRENT      (1u << INA226_REG_CURRENT)
+#define INA226_READ_ALL          (INA226_READ_SHUNT | INA226_READ_BUS | INA226_READ_POWER | INA226_READ_CURRENT)
+
+/* 中断采集的 I2C 传输方式: 1=DMA, 0=中断 (每次只读 2 字节, 中断方式开销更小) */
+#define INA226_IT_USE_DMA        0
+
+struct INA226_Handle;
+
+/* 转换完成回调 (在 I2C 完成中断中调用), 本次读到的寄存器已换算到句柄 (整数微单位, 以及浮点物理量) */
+typedef void (*INA226_Callback)(struct INA226_Handle *hdev);
+
+/* 超限报警回调 (在 I2C 完成中断中调用), flags 为读到的 Mask/Enable 值 */
+typedef void (*INA226_AlertCallback)(struct INA226_Handle *hdev, uint16_t flags);
+
+/* 中断采集统计 */
 typedef struct {
+    uint32_t Conversions;      // 读取完成的转换次数
+    uint32_t Late;             // 读取期间又完成了一次转换 (读完后紧接着再读, 不丢失)
+    uint32_t Alerts;           // 读到 AFF 置位的次数
+    uint32_t Spurious;         // ALERT 触发但 CVRF / AFF 均未置位
+    uint32_t Errors;           // I2C 启动或传输失败
+} INA226_ITStats_t;
+
+/* --- 对象句柄 --- */
+typedef struct INA226_Handle {
     I2C_HandleTypeDef *hi2c;   // I2C 句柄
     uint16_t Addr;             // 设备地址 (8-bit)
     
+#if INA226_USE_FLOAT
     // 物理参数 (初始化时传入)
     float ShuntResistor_Ohm;   // 分流电阻阻值 (例如 0.01 欧姆)
     float MaxCurrent_Amp;      // 预期最大电流 (例如 5.0 安培)
@@ -36,17 +141,49 @@ typedef struct {
     // 内部计算用的系数
     float Current_LSB;         // 电流分辨率 (A/bit)
     float Power_LSB;           // 功率分辨率 (W/bit)
+#endif
+
+    // 整数校准
+    uint32_t ShuntResistor_uOhm; // 分流电阻 (uOhm)
+    uint16_t Calibration;        // 写入的校准寄存器值
+    uint32_t CurrentLSB_uA_Q16;  // 由 CAL 反推的实际电流分辨率 (uA/bit, Q16)
+    uint16_t Config;           // 当前配置寄存器值
+    uint16_t MaskEnable;       // 当前 Mask/Enable 寄存器值 (报警功能 + CNVR + 锁存)
     
+#if INA226_USE_FLOAT
     // 测量结果缓存 (物理量)
     float Voltage_V;           // 总线电压 (V)
     float Current_A;           // 电流 (A)
     float Power_W;             // 功率 (W)
     float ShuntVoltage_mV;     // 分流电阻压降 (mV)
+#endif
+
+    // 测量结果缓存 (整数微单位, INA226_ReadAllInt / 中断采集)
+    int32_t  Bus_uV;           // 总线电压 (uV)
+    int32_t  Current_uA;       // 电流 (uA)
+    uint32_t Power_uW;         // 功率 (uW)
+    int32_t  Shunt_nV;         // 分流电阻压降 (nV, LSB 2.5uV 用 nV 表示才精确)
+
+    // 中断采集 (INA226_IT_Start)
+    uint16_t Raw[8];           // 最近一次读到的原始值, 按寄存器地址索引
+    volatile uint8_t ItActive;
+    volatile uint8_t ItBusy;   // 正在读取
+    volatile uint8_t ItPending;// 读取期间 ALERT 再次触发
+    uint32_t ItTime;           // 本次转换 ALERT 沿的时间戳 (INA226_TIMESTAMP)
+    uint32_t ItPendingTime;    // 挂起转换的 ALERT 沿
+    uint8_t  ItRegs;           // 每次转换读取的寄存器 (INA226_READ_xxx)
+    uint8_t  ItReg;            // 当前读取的寄存器
+    uint8_t  ItDone;           // 本次已读到的寄存器
+    uint8_t  ItBuf[2];
+    INA226_Callback  ItCallback;
+    INA226_AlertCallback AlertCallback;
+    INA226_ITStats_t ItStats;
     
 } INA226_HandleTypeDef;
 
 /* --- 函数声明 --- */
 
+#if INA226_USE_FLOAT
 /**
  * @brief 初始化 INA226
  * @param r_shunt: 分流电阻值 (单位: 欧姆)
@@ -59,10 +196,76 @@ HAL_StatusTypeDef INA226_ReadAll(INA226_HandleTypeDef *hdev);
 
 // 单独读取总线电压 (不依赖校准)
 HAL_StatusTypeDef INA226_GetBusVoltage(INA226_HandleTypeDef *hdev);
+#endif
+
+/**
+ * @brief 初始化 INA226 (整数参数, 不需要浮点)
+ * @param r_shunt_uohm: 分流电阻 (uOhm, 例如 2mOhm 传 2000)
+ * @param i_max_ma:     设计最大电流 (mA)
+ * @note  CAL 四舍五入, 电流 LSB 由写入的 CAL 反推, 与芯片内部计算一致
+ */
+HAL_StatusTypeDef INA226_InitInt(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, uint16_t addr,
+                                 uint32_t r_shunt_uohm, uint32_t i_max_ma);
+
+// 读取所有数据, 结果为整数微单位 (Bus_uV / Current_uA / Power_uW / Shunt_nV)
+HAL_StatusTypeDef INA226_ReadAllInt(INA226_HandleTypeDef *hdev);
+
+// 把 Raw[] 中 regs (INA226_READ_xxx) 对应的原始值换算为整数微单位
+void INA226_ConvertInt(INA226_HandleTypeDef *hdev, uint8_t regs);
 
 // 复位设备
 HAL_StatusTypeDef INA226_Reset(INA226_HandleTypeDef *hdev);
 
+/**
+ * @brief 设置平均次数、转换时间与工作模式 (可在运行中切换)
+ * @note  例: 快速瞬态 AVG_1 + 140us + SHUNT_CONT (140us 一次);
+ *            低噪声监控 AVG_1024 + 8244us + SHUNT_BUS_CONT (约 16.9s 一次)
+ *        中断采集期间返回 HAL_BUSY, 需先 INA226_IT_Stop
+ */
+HAL_StatusTypeDef INA226_SetConfig(INA226_HandleTypeDef *hdev, INA226_Avg_t avg, INA226_ConvTime_t vbus_ct,
+                                   INA226_ConvTime_t vsh_ct, INA226_Mode_t mode);
+
+// 触发模式下启动一次转换 (重写配置寄存器); 连续模式下会重新开始当前转换
+HAL_StatusTypeDef INA226_Trigger(INA226_HandleTypeDef *hdev);
+
+// 按当前配置计算一次完整转换 (含平均) 的时间 (us), 掉电模式返回 0
+uint32_t INA226_GetUpdatePeriod_us(const INA226_HandleTypeDef *hdev);
+
+/**
+ * @brief 启动 ALERT 转换完成中断采集: 每次转换只读一遍所选寄存器, 不再轮询
+ * @param regs: INA226_READ_xxx 组合 (只要电流和电压时可省掉功率与分流电压两次传输)
+ * @param cb:   转换完成回调, 可为 NULL (结果照常更新到句柄)
+ * @note  ALERT 为开漏低有效, 需上拉; MCU 侧 EXTI 设为下降沿触发.
+ *        采集期间不要再调用阻塞读写函数 (会与中断传输冲突)
+ */
+HAL_StatusTypeDef INA226_IT_Start(INA226_HandleTypeDef *hdev, uint8_t regs, INA226_Callback cb);
+HAL_StatusTypeDef INA226_IT_Stop(INA226_HandleTypeDef *hdev);
+
+/**
+ * @brief 设置超限报警: ALERT 引脚在一次转换内响应, 不需要轮询
+ * @param limit: 单位见 INA226_AlertFunc_t (A / V / W), INA226_ALERT_NONE 时忽略
+ * @param latch: 1=锁存, ALERT 保持到读 Mask/Enable (INA226_ClearAlert); 0=条件消失后自动释放
+ * @note  与中断采集同时使用时强制锁存 (否则超限期间 ALERT 一直为低, 转换完成没有下降沿),
+ *        中断采集期间返回 HAL_BUSY, 需在 INA226_IT_Start 之前设置
+ */
+#if INA226_USE_FLOAT
+HAL_StatusTypeDef INA226_SetAlert(INA226_HandleTypeDef *hdev, INA226_AlertFunc_t func, float limit, uint8_t latch);
+#endif
+// 整数版本: 限值单位 uA / uV / uW
+HAL_StatusTypeDef INA226_SetAlertInt(INA226_HandleTypeDef *hdev, INA226_AlertFunc_t func, int32_t limit, uint8_t latch);
+
+// 读 Mask/Enable (清除锁存的报警与 CVRF), flags 可为 NULL; 未启用中断采集时使用
+HAL_StatusTypeDef INA226_ClearAlert(INA226_HandleTypeDef *hdev, uint16_t *flags);
+
+// 中断采集时的超限报警回调 (与转换完成共用 ALERT, 读 Mask/Enable 后区分)
+void INA226_IT_SetAlertCallback(INA226_HandleTypeDef *hdev, INA226_AlertCallback cb);
+
+// 在 HAL_GPIO_EXTI_Callback 中 (ALERT 引脚) 调用;
+// I2C 出错后 ALERT 会一直保持低电平, 主循环发现 ALERT 为低且 ItBusy == 0 时也调用一次即可恢复
+void INA226_IT_EXTI_Callback(INA226_HandleTypeDef *hdev);
+// 在 HAL_I2C_MemRxCpltCallback (status = 0) / HAL_I2C_ErrorCallback (status = -1) 中调用
+void INA226_IT_I2C_Callback(INA226_HandleTypeDef *hdev, I2C_HandleTypeDef *hi2c, int8_t status);
+
 #ifdef __cplusplus
 }
 #endif
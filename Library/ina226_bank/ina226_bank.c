@@ -0,0 +1,300 @@
+#include "ina226_bank.h"
+#include <string.h> // for memset
+
+#if !INA226_USE_FLOAT
+#error "ina226_bank 的通道参数与快照为浮点, 需要 INA226_USE_FLOAT = 1"
+#endif
+
+// 扫描阶段
+#define BANK_IDLE     0
+#define BANK_TRIGGER  1
+#define BANK_WAIT     2
+#define BANK_READ     3
+
+// I2C 字节数 (含地址): 写寄存器 = 地址 + 指针 + 2, 读寄存器 = 地址 + 指针 + 地址 + 2
+#define BANK_WRITE_BYTES  4
+#define BANK_READ_BYTES   5
+
+// ================= 内部函数 =================
+
+// 切换到第 idx 个通道, 装入要读的寄存器
+static void INA226Bank_SelectRail(INA226Bank_t *bank, uint8_t idx) {
+    bank->rail = idx;
+    if (idx >= bank->n) return;
+
+    bank->left = bank->rails[idx].regs;
+#if INA226BANK_CHECK_READY
+    if (bank->left) bank->left |= 1u << INA226_REG_MASK_ENABLE;
+#endif
+}
+
+// 发布快照: 读完的一块成为前台, 下一周期写另一块
+static void INA226Bank_Publish(INA226Bank_t *bank) {
+    INA226Bank_Raw_t *back = &bank->snap[bank->front ^ 1];
+    uint32_t cycles = DWT->CYCCNT - bank->trig_time;
+
+    back->seq = bank->snap[bank->front].seq + 1;
+    back->tick = bank->period_start;
+    bank->front ^= 1;
+
+    bank->stats.sweeps++;
+    bank->stats.sweep_cycles = cycles;
+    if (cycles > bank->stats.sweep_cycles_max) bank->stats.sweep_cycles_max = cycles;
+    bank->stats.bus_bytes = bank->bytes;
+}
+
+/**
+ * @brief 启动下一笔传输; 当前阶段没有要做的传输时推进阶段
+ * @note  启动失败的通道记为出错并跳过, 不会卡住整个周期
+ */
+static void INA226Bank_Run(INA226Bank_t *bank) {
+    while (1) {
+        uint8_t idx = bank->rail;
+
+        if (bank->phase == BANK_TRIGGER) {
+            if (idx >= bank->n) {
+                bank->phase = BANK_WAIT;
+                return;
+            }
+            INA226Bank_Rail_t *r = &bank->rails[idx];
+            if (r->regs != 0) {
+                bank->buf[0] = bank->config >> 8;
+                bank->buf[1] = bank->config & 0xFF;
+                if (HAL_I2C_Mem_Write_IT(bank->hi2c, r->dev.Addr, INA226_REG_CONFIG, I2C_MEMADD_SIZE_8BIT,
+                                         bank->buf, 2) == HAL_OK) {
+                    bank->bytes += BANK_WRITE_BYTES;
+                    return;
+                }
+                bank->stats.errors[idx]++;
+                bank->failed |= (uint16_t)(1u << idx);
+            }
+            bank->rail++;
+            continue;
+        }
+
+        if (bank->phase == BANK_READ) {
+            if (idx >= bank->n) {
+                INA226Bank_Publish(bank);
+                bank->phase = BANK_IDLE;
+                return;
+            }
+            if (bank->left == 0 || (bank->failed & (1u << idx))) {
+                INA226Bank_SelectRail(bank, idx + 1);
+                continue;
+            }
+
+            // 先读 Mask/Enable, 再按地址从小到大读数据寄存器
+            uint8_t reg = INA226_REG_SHUNT_VOLTAGE;
+            if (bank->left & (1u << INA226_REG_MASK_ENABLE)) {
+                reg = INA226_REG_MASK_ENABLE;
+            } else {
+                while (!(bank->left & (1u << reg))) reg++;
+            }
+            bank->reg = reg;
+            if (HAL_I2C_Mem_Read_IT(bank->hi2c, bank->rails[idx].dev.Addr, reg, I2C_MEMADD_SIZE_8BIT,
+                                    bank->buf, 2) == HAL_OK) {
+                bank->bytes += BANK_READ_BYTES;
+                return;
+            }
+            bank->stats.errors[idx]++;
+            bank->failed |= (uint16_t)(1u << idx);
+            continue;
+        }
+        return;
+    }
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 扫描 INA226: 地址应答且 ID 寄存器匹配
+ */
+uint8_t INA226Bank_Scan(I2C_HandleTypeDef *hi2c, uint16_t *addrs, uint8_t max) {
+    uint8_t count = 0;
+
+    for (uint16_t a = 0x40; a <= 0x4F && count < max; a++) {
+        uint16_t addr = a << 1;
+        uint8_t id[2];
+
+        if (HAL_I2C_IsDeviceReady(hi2c, addr, 2, 10) != HAL_OK) continue;
+        if (HAL_I2C_Mem_Read(hi2c, addr, INA226_REG_MANUFACTURER, I2C_MEMADD_SIZE_8BIT, id, 2, 10) != HAL_OK) continue;
+        if (((id[0] << 8) | id[1]) != 0x5449) continue; // "TI"
+        if (HAL_I2C_Mem_Read(hi2c, addr, INA226_REG_DIE_ID, I2C_MEMADD_SIZE_8BIT, id, 2, 10) != HAL_OK) continue;
+        if ((((id[0] << 8) | id[1]) >> 4) != 0x226) continue;
+
+        addrs[count++] = addr;
+    }
+    return count;
+}
+
+void INA226Bank_Init(INA226Bank_t *bank, I2C_HandleTypeDef *hi2c, uint32_t period_ms,
+                     INA226_Avg_t avg, INA226_ConvTime_t vbus_ct, INA226_ConvTime_t vsh_ct) {
+    INA226_HandleTypeDef tmp;
+
+    memset(bank, 0, sizeof(*bank));
+    bank->hi2c = hi2c;
+    bank->period_ms = period_ms;
+    bank->config = 0x4000 | ((avg & 0x07) << 9) | ((vbus_ct & 0x07) << 6) | ((vsh_ct & 0x07) << 3) |
+                   INA226_MODE_SHUNT_BUS_TRIG;
+
+    tmp.Config = bank->config;
+    uint32_t wait_us = INA226_GetUpdatePeriod_us(&tmp);
+    wait_us += wait_us / INA226BANK_WAIT_MARGIN;
+    bank->wait_cycles = wait_us * (SystemCoreClock / 1000000);
+
+    // 使能 DWT 周期计数器, 用于等待转换与统计耗时
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/**
+ * @brief 添加通道, 写入触发模式配置 (写入后芯片先做一次转换, 不影响之后的周期)
+ */
+int8_t INA226Bank_AddRail(INA226Bank_t *bank, uint16_t addr, float r_shunt, float i_max) {
+    if (bank->n >= INA226BANK_MAX_RAILS || bank->phase != BANK_IDLE) return -1;
+
+    INA226Bank_Rail_t *r = &bank->rails[bank->n];
+    if (INA226_Init(&r->dev, bank->hi2c, addr, r_shunt, i_max) != HAL_OK) return -1;
+    uint16_t c = bank->config;
+    if (INA226_SetConfig(&r->dev, (INA226_Avg_t)((c >> 9) & 0x07), (INA226_ConvTime_t)((c >> 6) & 0x07),
+                         (INA226_ConvTime_t)((c >> 3) & 0x07), INA226_MODE_SHUNT_BUS_TRIG) != HAL_OK) {
+        return -1;
+    }
+    r->regs = 0;
+    memset(r->refs, 0, sizeof(r->refs));
+    return (int8_t)bank->n++;
+}
+
+void INA226Bank_Subscribe(INA226Bank_t *bank, uint8_t rail, uint8_t regs) {
+    if (rail >= bank->n) return;
+
+    INA226Bank_Rail_t *r = &bank->rails[rail];
+    for (uint8_t reg = INA226_REG_SHUNT_VOLTAGE; reg <= INA226_REG_CURRENT; reg++) {
+        if (!(regs & (1u << reg)) || r->refs[reg - 1] == 0xFF) continue;
+        r->refs[reg - 1]++;
+        r->regs |= (uint8_t)(1u << reg);
+    }
+}
+
+void INA226Bank_Unsubscribe(INA226Bank_t *bank, uint8_t rail, uint8_t regs) {
+    if (rail >= bank->n) return;
+
+    // 按寄存器减计数, 最后一个使用者退订后才停止读取
+    INA226Bank_Rail_t *r = &bank->rails[rail];
+    for (uint8_t reg = INA226_REG_SHUNT_VOLTAGE; reg <= INA226_REG_CURRENT; reg++) {
+        if (!(regs & (1u << reg)) || r->refs[reg - 1] == 0) continue;
+        if (--r->refs[reg - 1] == 0) r->regs &= (uint8_t)~(1u << reg);
+    }
+}
+
+/**
+ * @brief 周期调用: 周期到了开始触发, 等够转换时间开始读取
+ * @note  只在没有传输进行的阶段 (空闲 / 等待) 动作, 与 I2C 中断不冲突
+ */
+void INA226Bank_Tick(INA226Bank_t *bank) {
+    uint8_t phase = bank->phase;
+
+    if (phase == BANK_WAIT) {
+        if (DWT->CYCCNT - bank->trig_time < bank->wait_cycles) return;
+
+        bank->phase = BANK_READ;
+        INA226Bank_SelectRail(bank, 0);
+        INA226Bank_Run(bank);
+        return;
+    }
+
+    uint32_t now = HAL_GetTick();
+    if (now - bank->period_start < bank->period_ms) return;
+
+    if (phase != BANK_IDLE) {
+        // 上一周期还在读: 跳过本周期
+        bank->stats.overruns++;
+        bank->period_start = now;
+        return;
+    }
+
+    bank->period_start = now;
+    bank->trig_time = DWT->CYCCNT;
+    bank->failed = 0;
+    bank->bytes = 0;
+    bank->snap[bank->front ^ 1].valid = 0;
+    bank->phase = BANK_TRIGGER;
+    bank->rail = 0;
+    INA226Bank_Run(bank);
+}
+
+/**
+ * @brief I2C 完成 / 出错: 保存读到的值, 启动下一笔传输
+ */
+void INA226Bank_I2C_Callback(INA226Bank_t *bank, I2C_HandleTypeDef *hi2c, int8_t status) {
+    uint8_t phase = bank->phase;
+    uint8_t idx = bank->rail;
+
+    if (hi2c != bank->hi2c || (phase != BANK_TRIGGER && phase != BANK_READ)) return;
+
+    if (status != 0) {
+        bank->stats.errors[idx]++;
+        bank->failed |= (uint16_t)(1u << idx);
+        if (phase == BANK_TRIGGER) bank->rail++;
+        INA226Bank_Run(bank);
+        return;
+    }
+
+    if (phase == BANK_TRIGGER) {
+        bank->rail++;
+        INA226Bank_Run(bank);
+        return;
+    }
+
+    uint16_t val = (bank->buf[0] << 8) | bank->buf[1];
+    uint8_t reg = bank->reg;
+
+    bank->left &= ~(1u << reg);
+    if (reg == INA226_REG_MASK_ENABLE) {
+        if (!(val & INA226_MASK_CVRF)) {
+            // 转换还没完成: 本周期放弃该通道 (等待余量不够时会经常出现)
+            bank->stats.not_ready++;
+            bank->failed |= (uint16_t)(1u << idx);
+        }
+    } else {
+        INA226Bank_Raw_t *back = &bank->snap[bank->front ^ 1];
+        back->raw[idx][reg - 1] = val;
+        if (bank->left == 0) back->valid |= (uint16_t)(1u << idx);
+    }
+    INA226Bank_Run(bank);
+}
+
+void INA226Bank_GetRaw(INA226Bank_t *bank, INA226Bank_Raw_t *out) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    *out = bank->snap[bank->front];
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief 取最近一份快照并换算
+ */
+void INA226Bank_GetSnapshot(INA226Bank_t *bank, INA226Bank_Snapshot_t *out) {
+    INA226Bank_Raw_t raw;
+
+    INA226Bank_GetRaw(bank, &raw);
+    memset(out, 0, sizeof(*out));
+    out->seq = raw.seq;
+    out->tick = raw.tick;
+    out->valid = raw.valid;
+
+    for (uint8_t i = 0; i < bank->n; i++) {
+        const INA226_HandleTypeDef *dev = &bank->rails[i].dev;
+        uint8_t regs = bank->rails[i].regs;
+
+        if (!(raw.valid & (1u << i))) continue;
+        if (regs & INA226_READ_SHUNT)   out->rail[i].shunt_mv = (int16_t)raw.raw[i][INA226_REG_SHUNT_VOLTAGE - 1] * 0.0025f;
+        if (regs & INA226_READ_BUS)     out->rail[i].voltage_v = raw.raw[i][INA226_REG_BUS_VOLTAGE - 1] * 0.00125f;
+        if (regs & INA226_READ_POWER)   out->rail[i].power_w = raw.raw[i][INA226_REG_POWER - 1] * dev->Power_LSB;
+        if (regs & INA226_READ_CURRENT) out->rail[i].current_a = (int16_t)raw.raw[i][INA226_REG_CURRENT - 1] * dev->Current_LSB;
+    }
+}
+
+void INA226Bank_GetStats(const INA226Bank_t *bank, INA226Bank_Stats_t *stats) {
+    *stats = bank->stats;
+}
@@ -0,0 +1,146 @@
+#ifndef __INA226_BANK_H__
+#define __INA226_BANK_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "ina226.h"
+
+/*
+ * 多路 INA226 (同一条 I2C 上最多 16 片) 的定时扫描.
+ *
+ * 各片工作在触发模式, 每个周期:
+ * 1. 触发: 依次写各片配置寄存器启动一次转换 (每片一次 4 字节写, 相邻两片错开一笔传输的时间);
+ * 2. 等待: 一次转换时间 (含余量), 期间总线空闲;
+ * 3. 读取: 按触发顺序依次读各片订阅的寄存器, 每片的转换窗口与读取时刻错开的量相同,
+ *    全部读完后整体发布为一份快照 (双缓冲), 各通道对应同一个转换窗口.
+ *
+ * 所有传输都是 I2C 中断方式, 由完成回调串起来, 主循环只需周期调用 INA226Bank_Tick.
+ * 只读订阅了的寄存器: 例如只关心电流的通道每周期只有 1 次读 (可选再加 1 次就绪检查).
+ */
+
+// ================= 配置区域 =================
+
+/* 最多通道数 (INA226 地址 A0/A1 组合共 16 个; 用不到时可改小, 每通道约占 160 字节 RAM) */
+#define INA226BANK_MAX_RAILS    16
+
+/* 读数据前先读 Mask/Enable 确认转换完成 (每通道多 1 次读): 1=检查, 0=只按时间 */
+#define INA226BANK_CHECK_READY  1
+
+/* 等待时间余量: 标称转换时间 x (1 + 1/N), 芯片内部时钟有误差 */
+#define INA226BANK_WAIT_MARGIN  8
+
+// ================= 数据结构 =================
+
+/* 一个通道 */
+typedef struct {
+    INA226_HandleTypeDef dev;
+    uint8_t  regs;                    // 订阅的寄存器 (INA226_READ_xxx), 0 表示不读
+    uint8_t  refs[4];                 // 各寄存器 (地址 1~4) 的订阅者数, 减到 0 才不读
+} INA226Bank_Rail_t;
+
+/* 原始快照 (中断中填写) */
+typedef struct {
+    uint32_t seq;
+    uint32_t tick;                    // 本周期触发时刻 (HAL_GetTick)
+    uint16_t valid;                   // 本周期读到的通道
+    uint16_t raw[INA226BANK_MAX_RAILS][4]; // 按寄存器地址 1~4: 分流电压 / 总线电压 / 功率 / 电流
+} INA226Bank_Raw_t;
+
+/* 换算后的快照 */
+typedef struct {
+    uint32_t seq;                     // 周期序号, 不变说明还没有新数据
+    uint32_t tick;
+    uint16_t valid;                   // bit n: 通道 n 本周期有效
+    struct {
+        float voltage_v;              // 未订阅的量为 0
+        float current_a;
+        float power_w;
+        float shunt_mv;
+    } rail[INA226BANK_MAX_RAILS];
+} INA226Bank_Snapshot_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t sweeps;                  // 完成的周期数
+    uint32_t overruns;                // 上一周期还没读完, 跳过的周期
+    uint32_t not_ready;               // 读取时转换还没完成的次数 (INA226BANK_CHECK_READY)
+    uint32_t errors[INA226BANK_MAX_RAILS];
+    uint32_t sweep_cycles;            // 最近一个周期从触发到发布的耗时 (CPU 周期)
+    uint32_t sweep_cycles_max;
+    uint32_t bus_bytes;               // 最近一个周期的 I2C 字节数 (含地址)
+} INA226Bank_Stats_t;
+
+typedef struct {
+    I2C_HandleTypeDef  *hi2c;
+    INA226Bank_Rail_t   rails[INA226BANK_MAX_RAILS];
+    uint8_t             n;
+
+    // 公共转换配置
+    uint16_t            config;       // 触发模式的配置寄存器值
+    uint32_t            period_ms;
+    uint32_t            wait_cycles;  // 触发到开始读取的等待 (CPU 周期)
+
+    // 扫描状态 (中断中推进)
+    volatile uint8_t    phase;
+    uint8_t             rail;         // 当前通道
+    uint8_t             left;         // 当前通道还要读的寄存器 (按地址取位)
+    uint8_t             reg;          // 正在读的寄存器
+    uint16_t            failed;       // 本周期出错的通道
+    uint8_t             buf[2];
+    uint32_t            period_start; // HAL_GetTick
+    uint32_t            trig_time;    // 第一次触发的 DWT 计数
+    uint32_t            bytes;
+
+    INA226Bank_Raw_t    snap[2];      // 双缓冲
+    volatile uint8_t    front;        // 已发布的一块
+
+    INA226Bank_Stats_t  stats;
+} INA226Bank_t;
+
+// ================= 函数声明 =================
+
+/**
+ * @brief 扫描总线上的 INA226 (阻塞, 初始化时调用)
+ * @param addrs 输出 8 位地址 (0x80 ~ 0x9E), 按地址从小到大
+ * @return 找到的数量 (只统计厂商 ID 为 TI 且芯片 ID 为 INA226 的设备)
+ */
+uint8_t INA226Bank_Scan(I2C_HandleTypeDef *hi2c, uint16_t *addrs, uint8_t max);
+
+/**
+ * @brief 初始化
+ * @param period_ms 扫描周期, 需大于 转换时间 + 所有通道读取时间
+ */
+void   INA226Bank_Init(INA226Bank_t *bank, I2C_HandleTypeDef *hi2c, uint32_t period_ms,
+                       INA226_Avg_t avg, INA226_ConvTime_t vbus_ct, INA226_ConvTime_t vsh_ct);
+
+/**
+ * @brief 添加通道 (阻塞: 初始化、校准、写入触发模式配置)
+ * @return 通道号, <0 失败
+ */
+int8_t INA226Bank_AddRail(INA226Bank_t *bank, uint16_t addr, float r_shunt, float i_max);
+
+/* 订阅: 通道 rail 每周期读取 regs (INA226_READ_xxx), 多个使用者的订阅按寄存器计数,
+ * 每个使用者退订自己订阅过的寄存器, 其他使用者仍需要的寄存器继续读取 */
+void   INA226Bank_Subscribe(INA226Bank_t *bank, uint8_t rail, uint8_t regs);
+void   INA226Bank_Unsubscribe(INA226Bank_t *bank, uint8_t rail, uint8_t regs);
+
+/* 周期调用 (主循环或 1ms 定时中断): 到点启动触发 / 读取, 其余由 I2C 中断推进 */
+void   INA226Bank_Tick(INA226Bank_t *bank);
+
+/* 在 HAL_I2C_MemTxCpltCallback / HAL_I2C_MemRxCpltCallback (status = 0) 与 HAL_I2C_ErrorCallback (-1) 中调用 */
+void   INA226Bank_I2C_Callback(INA226Bank_t *bank, I2C_HandleTypeDef *hi2c, int8_t status);
+
+/* 取最近一份完整快照 (换算为物理量) */
+void   INA226Bank_GetSnapshot(INA226Bank_t *bank, INA226Bank_Snapshot_t *out);
+void   INA226Bank_GetRaw(INA226Bank_t *bank, INA226Bank_Raw_t *out);
+
+void   INA226Bank_GetStats(const INA226Bank_t *bank, INA226Bank_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INA226_BANK_H__ */
@@ -0,0 +1,239 @@
+#include "spi_bus.h"
+#include <string.h> // for NULL
+
+#define SPI_BUS_CR1_PROFILE_MASK  (SPI_CR1_CPOL | SPI_CR1_CPHA | SPI_CR1_BR)
+
+// ================= 内部静态辅助函数 =================
+
+/**
+ * @brief 切换到设备的时序配置 (只有 CR1 确实不同才改写)
+ * @note  调用时片选必须全部为高, 上一次传输已经结束
+ */
+static void SPIBus_ApplyProfile(SPIBus_t *bus, SPIBus_Device_t *dev) {
+    if (bus->profile == dev) return;
+
+    SPI_TypeDef *spi = bus->hspi->Instance;
+    uint32_t cr1 = spi->CR1;
+    uint32_t want = (cr1 & ~SPI_BUS_CR1_PROFILE_MASK) | dev->cr1;
+
+    if (want != cr1) {
+        // 关闭 SPE 后再改时钟相位/分频, 下次 HAL 传输时会自动重新使能
+        spi->CR1 = cr1 & ~SPI_CR1_SPE;
+        spi->CR1 = want & ~SPI_CR1_SPE;
+
+        // 同步到 HAL 句柄, 保持 Init 与寄存器一致
+        bus->hspi->Init.CLKPolarity = dev->cr1 & SPI_CR1_CPOL;
+        bus->hspi->Init.CLKPhase = dev->cr1 & SPI_CR1_CPHA;
+        bus->hspi->Init.BaudRatePrescaler = dev->cr1 & SPI_CR1_BR;
+        bus->stats.profile_switches++;
+    }
+    bus->profile = dev;
+}
+
+/**
+ * @brief 结束一次异步传输并通知调用者
+ */
+static void SPIBus_Finish(SPIBus_t *bus, SPIBus_Xfer_t *xfer, int8_t status) {
+    HAL_GPIO_WritePin(xfer->dev->cs_port, xfer->dev->cs_pin, GPIO_PIN_SET);
+    bus->current = NULL;
+
+    if (status == 0) bus->stats.async_done++;
+    else bus->stats.async_errors++;
+
+    if (xfer->done != NULL) xfer->done(xfer, status);
+}
+
+/**
+ * @brief 总线空闲时启动队首传输 (调用者需关中断)
+ * @note  有同步方在等待时, 只放行优先级更高的异步传输
+ */
+static void SPIBus_Dispatch(SPIBus_t *bus) {
+    while (bus->current == NULL && bus->owner == NULL && bus->queue != NULL) {
+        SPIBus_Xfer_t *xfer = bus->queue;
+
+        if (bus->waiting_prio >= 0 && xfer->priority <= bus->waiting_prio) return;
+
+        bus->queue = xfer->next;
+        bus->queue_depth--;
+        bus->current = xfer;
+
+        SPIBus_ApplyProfile(bus, xfer->dev);
+        HAL_GPIO_WritePin(xfer->dev->cs_port, xfer->dev->cs_pin, GPIO_PIN_RESET);
+
+        HAL_StatusTypeDef status;
+#if SPI_BUS_USE_DMA
+        if (xfer->tx && xfer->rx) {
+            status = HAL_SPI_TransmitReceive_DMA(bus->hspi, xfer->tx, xfer->rx, xfer->len);
+        } else if (xfer->tx) {
+            status = HAL_SPI_Transmit_DMA(bus->hspi, xfer->tx, xfer->len);
+        } else {
+            status = HAL_SPI_Receive_DMA(bus->hspi, xfer->rx, xfer->len);
+        }
+        if (status == HAL_OK) return; // 等 SPIBus_IRQCallback
+
+        SPIBus_Finish(bus, xfer, -1);
+#else
+        if (xfer->tx && xfer->rx) {
+            status = HAL_SPI_TransmitReceive(bus->hspi, xfer->tx, xfer->rx, xfer->len, SPI_BUS_TIMEOUT);
+        } else if (xfer->tx) {
+            status = HAL_SPI_Transmit(bus->hspi, xfer->tx, xfer->len, SPI_BUS_TIMEOUT);
+        } else {
+            status = HAL_SPI_Receive(bus->hspi, xfer->rx, xfer->len, SPI_BUS_TIMEOUT);
+        }
+        SPIBus_Finish(bus, xfer, (status == HAL_OK) ? 0 : -1);
+#endif
+    }
+}
+
+// 一个 Acquire 调用者结束等待 (调用者需关中断)
+// 最后一个等待者离开才清除; 其余等待者优先级更低时仍按原值阻挡异步传输, 宁可多等不插队
+static void SPIBus_Unwait(SPIBus_t *bus) {
+    if (bus->waiters > 0 && --bus->waiters == 0) bus->waiting_prio = -1;
+}
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化总线对象
+ */
+void SPIBus_Init(SPIBus_t *bus, SPI_HandleTypeDef *hspi) {
+    memset(bus, 0, sizeof(SPIBus_t));
+    bus->hspi = hspi;
+    bus->waiting_prio = -1;
+}
+
+/**
+ * @brief 注册设备并预先计算 CR1 时序位
+ */
+void SPIBus_AddDevice(SPIBus_t *bus, SPIBus_Device_t *dev, GPIO_TypeDef *cs_port, uint16_t cs_pin,
+                      uint32_t cpol, uint32_t cpha, uint32_t prescaler, uint8_t priority) {
+    dev->bus = bus;
+    dev->cs_port = cs_port;
+    dev->cs_pin = cs_pin;
+    dev->cr1 = (uint16_t)((cpol | cpha | prescaler) & SPI_BUS_CR1_PROFILE_MASK);
+    dev->priority = priority;
+
+    HAL_GPIO_WritePin(cs_port, cs_pin, GPIO_PIN_SET); // 默认不选中
+}
+
+/**
+ * @brief 同步独占总线 (不可嵌套)
+ * @return 0: 成功, -1: 超时
+ */
+int8_t SPIBus_Acquire(SPIBus_Device_t *dev, uint32_t timeout) {
+    SPIBus_t *bus = dev->bus;
+    uint32_t start = HAL_GetTick();
+    uint8_t waiting = 0;
+
+    while (1) {
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (bus->owner == NULL && bus->current == NULL) {
+            bus->owner = dev;
+            if (waiting) SPIBus_Unwait(bus);
+            __set_PRIMASK(primask);
+
+            SPIBus_ApplyProfile(bus, dev);
+            return 0;
+        }
+        // 登记等待, 阻止更低优先级的异步传输继续插队
+        if (!waiting) {
+            bus->waiters++;
+            waiting = 1;
+        }
+        if (dev->priority > bus->waiting_prio) bus->waiting_prio = dev->priority;
+        __set_PRIMASK(primask);
+
+        if (HAL_GetTick() - start > timeout) {
+            primask = __get_PRIMASK();
+            __disable_irq();
+            SPIBus_Unwait(bus);
+            __set_PRIMASK(primask);
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief 释放总线, 并启动排队中的异步传输
+ */
+void SPIBus_Release(SPIBus_Device_t *dev) {
+    SPIBus_t *bus = dev->bus;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (bus->owner == dev) {
+        bus->owner = NULL;
+        SPIBus_Dispatch(bus);
+    }
+    __set_PRIMASK(primask);
+}
+
+void SPIBus_Select(SPIBus_Device_t *dev) {
+    HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_RESET);
+}
+
+void SPIBus_Deselect(SPIBus_Device_t *dev) {
+    HAL_GPIO_WritePin(dev->cs_port, dev->cs_pin, GPIO_PIN_SET);
+}
+
+/**
+ * @brief 同步传输 (需先 Acquire + Select)
+ */
+int8_t SPIBus_Transfer(SPIBus_Device_t *dev, uint8_t *tx, uint8_t *rx, uint16_t len) {
+    SPI_HandleTypeDef *hspi = dev->bus->hspi;
+    HAL_StatusTypeDef status;
+
+    if (tx && rx) {
+        status = HAL_SPI_TransmitReceive(hspi, tx, rx, len, SPI_BUS_TIMEOUT);
+    } else if (tx) {
+        status = HAL_SPI_Transmit(hspi, tx, len, SPI_BUS_TIMEOUT);
+    } else {
+        status = HAL_SPI_Receive(hspi, rx, len, SPI_BUS_TIMEOUT);
+    }
+    return (status == HAL_OK) ? 0 : -1;
+}
+
+/**
+ * @brief 提交异步传输, 按优先级插入队列
+ */
+int8_t SPIBus_Submit(SPIBus_Xfer_t *xfer) {
+    if (xfer == NULL || xfer->dev == NULL || xfer->len == 0) return -1;
+    if (xfer->tx == NULL && xfer->rx == NULL) return -1;
+
+    SPIBus_t *bus = xfer->dev->bus;
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    // 插到第一个优先级更低的节点之前, 同优先级保持先进先出
+    SPIBus_Xfer_t **pp = &bus->queue;
+    while (*pp != NULL && (*pp)->priority >= xfer->priority) {
+        pp = &(*pp)->next;
+    }
+    xfer->next = *pp;
+    *pp = xfer;
+
+    bus->queue_depth++;
+    if (bus->queue_depth > bus->stats.queue_depth_max) bus->stats.queue_depth_max = bus->queue_depth;
+
+    SPIBus_Dispatch(bus);
+    __set_PRIMASK(primask);
+    return 0;
+}
+
+/**
+ * @brief SPI DMA 完成/出错时调用
+ * @note  同步占用方自己发起的 DMA (如 W25Q_USE_DMA) 也会进来, 此时 current 为空直接忽略
+ */
+void SPIBus_IRQCallback(SPIBus_t *bus, SPI_HandleTypeDef *hspi, int8_t status) {
+    if (hspi != bus->hspi) return;
+
+    SPIBus_Xfer_t *xfer = bus->current;
+    if (xfer == NULL) return;
+
+    SPIBus_Finish(bus, xfer, status);
+
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    SPIBus_Dispatch(bus);
+    __set_PRIMASK(primask);
+}
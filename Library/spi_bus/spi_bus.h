@@ -0,0 +1,113 @@
+#ifndef __SPI_BUS_H__
+#define __SPI_BUS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+
+/*
+ * SPI 总线仲裁器: 多个设备 (W25Q / ICM42688 ...) 共用一条 SPI 时使用.
+ *
+ * 两种访问方式:
+ * 1. 同步独占: SPIBus_Acquire -> Select -> Transfer... -> Deselect -> Release
+ *    (W25Q / ICM42688 驱动在 *_USE_SPI_BUS = 1 时自动走这条路径)
+ * 2. 异步队列: SPIBus_Submit 提交一个 DMA 传输, 可在中断中调用, 按优先级排队.
+ *    总线一空闲 (当前传输完成 / 同步占用方 Release) 就启动队首.
+ *
+ * 每个设备有自己的 CPOL/CPHA/分频, 切换设备时只有配置不同才改写一次 CR1.
+ * W25Q 每条命令结束都会 Release, 所以高优先级的 IMU 读取可以插在两次页编程之间.
+ */
+
+// ================= 配置区域 =================
+
+/* 异步传输是否使用 DMA: 1=DMA, 0=在调度处阻塞完成 (中断中也会阻塞, 仅调试用) */
+#define SPI_BUS_USE_DMA      1
+
+/* 同步传输超时 (ms) */
+#define SPI_BUS_TIMEOUT      100
+
+// ================= 数据结构 =================
+
+struct SPIBus;
+struct SPIBus_Xfer;
+
+/* 总线上的一个设备 (片选 + 时序配置) */
+typedef struct {
+    struct SPIBus *bus;
+    GPIO_TypeDef  *cs_port;
+    uint16_t       cs_pin;
+    uint16_t       cr1;       // 预先算好的 CPOL | CPHA | BR 位
+    uint8_t        priority;  // 同步占用时的优先级, 数值越大越优先
+} SPIBus_Device_t;
+
+/* 异步传输完成回调 (在 SPI DMA 中断中调用), status: 0 成功, <0 失败 */
+typedef void (*SPIBus_DoneCallback)(struct SPIBus_Xfer *xfer, int8_t status);
+
+/* 异步传输描述符, 由调用者分配, 完成回调之前不能修改或释放 */
+typedef struct SPIBus_Xfer {
+    SPIBus_Device_t     *dev;
+    uint8_t             *tx;       // NULL: 只收 (发送 0xFF)
+    uint8_t             *rx;       // NULL: 只发
+    uint16_t             len;
+    uint8_t              priority; // 数值越大越优先, 同优先级先进先出
+    SPIBus_DoneCallback  done;
+    void                *ctx;      // 用户参数
+    struct SPIBus_Xfer  *next;     // 内部使用
+} SPIBus_Xfer_t;
+
+/* 统计信息 */
+typedef struct {
+    uint32_t profile_switches; // 实际改写 CR1 的次数
+    uint32_t async_done;       // 完成的异步传输数
+    uint32_t async_errors;     // 启动或传输失败数
+    uint8_t  queue_depth_max;  // 队列最大深度
+} SPIBus_Stats_t;
+
+/* 总线对象 */
+typedef struct SPIBus {
+    SPI_HandleTypeDef          *hspi;
+    SPIBus_Device_t            *profile;   // 当前 CR1 对应的设备
+    SPIBus_Device_t * volatile  owner;     // 同步占用方
+    SPIBus_Xfer_t   * volatile  current;   // 正在进行的异步传输
+    SPIBus_Xfer_t              *queue;     // 按优先级排序的等待队列
+    volatile int16_t            waiting_prio; // 等待 Acquire 的最高优先级, -1 无
+    volatile uint8_t            waiters;   // 正在等待 Acquire 的调用者数 (含中断中调用的)
+    uint8_t                     queue_depth;
+    SPIBus_Stats_t              stats;
+} SPIBus_t;
+
+// ================= 函数声明 =================
+
+/* 初始化 (hspi 必须已由 MX_SPIx_Init 初始化) */
+void SPIBus_Init(SPIBus_t *bus, SPI_HandleTypeDef *hspi);
+
+/**
+ * @brief 注册设备
+ * @param cpol      SPI_POLARITY_LOW / SPI_POLARITY_HIGH
+ * @param cpha      SPI_PHASE_1EDGE / SPI_PHASE_2EDGE
+ * @param prescaler SPI_BAUDRATEPRESCALER_x
+ * @param priority  同步占用优先级 (与异步传输的 priority 比较)
+ */
+void SPIBus_AddDevice(SPIBus_t *bus, SPIBus_Device_t *dev, GPIO_TypeDef *cs_port, uint16_t cs_pin,
+                      uint32_t cpol, uint32_t cpha, uint32_t prescaler, uint8_t priority);
+
+/* 同步独占 */
+int8_t SPIBus_Acquire(SPIBus_Device_t *dev, uint32_t timeout);
+void   SPIBus_Release(SPIBus_Device_t *dev);
+void   SPIBus_Select(SPIBus_Device_t *dev);
+void   SPIBus_Deselect(SPIBus_Device_t *dev);
+int8_t SPIBus_Transfer(SPIBus_Device_t *dev, uint8_t *tx, uint8_t *rx, uint16_t len);
+
+/* 异步队列 (可在中断中调用) */
+int8_t SPIBus_Submit(SPIBus_Xfer_t *xfer);
+
+/* 在 HAL_SPI_TxRxCpltCallback / TxCplt / RxCplt / ErrorCallback 中调用 */
+void SPIBus_IRQCallback(SPIBus_t *bus, SPI_HandleTypeDef *hspi, int8_t status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SPI_BUS_H__ */
@@ -0,0 +1,230 @@
+#include "vibration.h"
+#include "arm_math.h"
+#include <math.h>
+#include <string.h> // for memcpy
+
+// ================= 内部状态 =================
+
+// 乒乓帧缓冲: [缓冲][轴][采样], 原始 int16
+static int16_t s_frame[2][3][VIB_FFT_LEN_MAX];
+static float   s_work[VIB_FFT_LEN_MAX];    // 加窗后的时域数据 (FFT 会改写)
+static float   s_fft[VIB_FFT_LEN_MAX];     // FFT 输出 / 幅值平方
+static float   s_window[VIB_FFT_LEN_MAX];  // Hann 窗
+#if VIB_STORE_SPECTRUM
+static float   s_spectrum[3][VIB_FFT_LEN_MAX / 2];
+#endif
+
+static arm_rfft_fast_instance_f32 s_rfft;
+
+static uint16_t s_len;
+static uint16_t s_hop;
+static float    s_fs;
+static float    s_scale;
+static VIB_Source_t s_src;
+
+// 频谱换算系数 (在 Init 中算好)
+static float s_amp_k;    // |X| -> 单边峰值幅值: 2 / (N * 窗相干增益)
+static float s_power_k;  // sum|X|^2 -> 均方值: 2 / (N * sum(w^2))
+
+static float   s_edges[VIB_MAX_BANDS + 1];
+static uint8_t s_n_bands;
+
+// 采集状态 (中断中修改)
+static volatile uint8_t s_fill;   // 正在填充的缓冲
+static volatile int8_t  s_ready;  // 待处理的缓冲, -1 表示无
+static volatile uint16_t s_pos;   // 填充位置
+
+static VIB_Result_t s_result;
+static VIB_Stats_t  s_stats;
+
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化: 生成窗函数, 初始化 FFT
+ */
+int8_t VIB_Init(uint16_t fft_len, uint16_t hop, float sample_rate_hz, float scale) {
+    if (fft_len > VIB_FFT_LEN_MAX || (fft_len & (fft_len - 1)) != 0) return -1;
+    if (hop == 0 || hop > fft_len || sample_rate_hz <= 0.0f) return -1;
+    if (arm_rfft_fast_init_f32(&s_rfft, fft_len) != ARM_MATH_SUCCESS) return -1;
+
+    s_len = fft_len;
+    s_hop = hop;
+    s_fs = sample_rate_hz;
+    s_scale = scale;
+    s_src = VIB_SRC_ACCEL;
+
+    // Hann 窗, 同时累计相干增益与能量
+    float sum = 0.0f, sum_sq = 0.0f;
+    for (uint16_t i = 0; i < fft_len; i++) {
+        float w = 0.5f - 0.5f * cosf(2.0f * PI * i / fft_len);
+        s_window[i] = w;
+        sum += w;
+        sum_sq += w * w;
+    }
+    s_amp_k = 2.0f / sum;
+    s_power_k = 2.0f / ((float)fft_len * sum_sq);
+
+    s_n_bands = 0;
+    s_fill = 0;
+    s_ready = -1;
+    s_pos = 0;
+    memset(&s_result, 0, sizeof(s_result));
+    memset(&s_stats, 0, sizeof(s_stats));
+
+    // 使能 DWT 周期计数器, 用于测量处理耗时
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    return 0;
+}
+
+void VIB_SetSource(VIB_Source_t src) {
+    s_src = src;
+}
+
+/**
+ * @brief 设置频带边界
+ */
+int8_t VIB_SetBands(const float *edges_hz, uint8_t n_bands) {
+    if (n_bands > VIB_MAX_BANDS) return -1;
+    for (uint8_t i = 0; i < n_bands; i++) {
+        if (edges_hz[i + 1] <= edges_hz[i]) return -1;
+    }
+
+    memcpy(s_edges, edges_hz, (n_bands + 1) * sizeof(float));
+    s_n_bands = n_bands;
+    return 0;
+}
+
+/**
+ * @brief 输入一批采样, 攒满一帧就切换缓冲
+ * @note  帧移小于帧长时, 把当前帧末尾 (len - hop) 个采样复制到下一帧开头
+ */
+void VIB_Push(const ICM_RawData_t *samples, uint16_t n) {
+    uint16_t keep = s_len - s_hop;
+
+    for (uint16_t i = 0; i < n; i++) {
+        const ICM_RawData_t *s = &samples[i];
+        int16_t (*f)[VIB_FFT_LEN_MAX] = s_frame[s_fill];
+        uint16_t pos = s_pos;
+
+        if (s_src == VIB_SRC_ACCEL) {
+            f[0][pos] = s->accel_x_raw;
+            f[1][pos] = s->accel_y_raw;
+            f[2][pos] = s->accel_z_raw;
+        } else {
+            f[0][pos] = s->gyro_x_raw;
+            f[1][pos] = s->gyro_y_raw;
+            f[2][pos] = s->gyro_z_raw;
+        }
+
+        if (++pos < s_len) {
+            s_pos = pos;
+            continue;
+        }
+
+        // 一帧已满
+        uint8_t next;
+        if (s_ready < 0) {
+            s_ready = (int8_t)s_fill;
+            next = s_fill ^ 1;
+        } else {
+            next = s_fill; // 上一帧还没处理完: 丢弃本帧, 原地继续
+            s_stats.overruns++;
+        }
+
+        if (keep > 0) {
+            for (uint8_t a = 0; a < 3; a++) {
+                memmove(s_frame[next][a], &f[a][s_hop], keep * sizeof(int16_t));
+            }
+        }
+        s_fill = next;
+        s_pos = keep;
+    }
+    s_stats.samples += n;
+}
+
+/**
+ * @brief 处理一帧: 去直流 -> RMS -> 加窗 -> 实数 FFT -> 幅值谱与频带
+ */
+int8_t VIB_Process(void) {
+    int8_t idx = s_ready;
+    if (idx < 0) return 0;
+
+    uint32_t start = DWT->CYCCNT;
+    uint16_t half = s_len / 2;
+    float bin_hz = s_fs / s_len;
+    // arm_q15_to_float 得到 raw / 32768, 再乘回 32768 * scale
+    float k = 32768.0f * s_scale;
+
+    for (uint8_t a = 0; a < 3; a++) {
+        float mean, power;
+
+        arm_q15_to_float(s_frame[idx][a], s_work, s_len);
+        arm_mean_f32(s_work, s_len, &mean);
+        arm_offset_f32(s_work, -mean, s_work, s_len);
+        arm_power_f32(s_work, s_len, &power);
+        s_result.rms[a] = sqrtf(power / s_len) * k;
+
+        arm_mult_f32(s_work, s_window, s_work, s_len);
+        arm_rfft_fast_f32(&s_rfft, s_work, s_fft, 0);
+
+        // 输出格式: [DC, Nyquist, Re1, Im1, Re2, Im2 ...], 第 k 点幅值平方放到 s_fft[k]
+        arm_cmplx_mag_squared_f32(&s_fft[2], &s_fft[1], half - 1);
+        s_fft[0] = 0.0f; // 已去直流
+
+        // 频带均方值 (Parseval), 在开方前统计; 频带为 [e_b, e_b+1), 正好落在边界上的频点只计入高频一侧
+        for (uint8_t b = 0; b < s_n_bands; b++) {
+            int32_t lo = (int32_t)ceilf(s_edges[b] / bin_hz);
+            int32_t hi = (int32_t)ceilf(s_edges[b + 1] / bin_hz) - 1;
+            float acc = 0.0f;
+
+            if (lo < 1) lo = 1;
+            if (hi > (int32_t)half - 1) hi = half - 1;
+            for (int32_t i = lo; i <= hi; i++) acc += s_fft[i];
+            s_result.band_rms[a][b] = sqrtf(acc * s_power_k) * k;
+        }
+
+        // 峰值与幅值谱
+        float peak = 0.0f;
+        uint16_t peak_i = 0;
+        for (uint16_t i = 1; i < half; i++) {
+            float m2 = s_fft[i];
+            if (m2 > peak) {
+                peak = m2;
+                peak_i = i;
+            }
+#if VIB_STORE_SPECTRUM
+            s_spectrum[a][i] = sqrtf(m2) * s_amp_k * k;
+#endif
+        }
+#if VIB_STORE_SPECTRUM
+        s_spectrum[a][0] = 0.0f;
+#endif
+        s_result.peak_hz[a] = peak_i * bin_hz;
+        s_result.peak_amp[a] = sqrtf(peak) * s_amp_k * k;
+    }
+
+    s_result.n_bands = s_n_bands;
+    s_result.seq++;
+    s_ready = -1; // 释放缓冲, 采集端可以再次切换过来
+
+    uint32_t cycles = DWT->CYCCNT - start;
+    s_stats.windows++;
+    s_stats.proc_cycles = cycles;
+    if (cycles > s_stats.proc_cycles_max) s_stats.proc_cycles_max = cycles;
+    return 1;
+}
+
+const VIB_Result_t *VIB_GetResult(void) {
+    return &s_result;
+}
+
+#if VIB_STORE_SPECTRUM
+const float *VIB_GetSpectrum(uint8_t axis) {
+    return (axis < 3) ? s_spectrum[axis] : NULL;
+}
+#endif
+
+void VIB_GetStats(VIB_Stats_t *stats) {
+    *stats = s_stats;
+}
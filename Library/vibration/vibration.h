@@ -0,0 +1,97 @@
+#ifndef __VIBRATION_H__
+#define __VIBRATION_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "main.h"
+#include "icm42688.h"
+
+/*
+ * 振动频谱分析: ICM42688 FIFO 数据 -> 乒乓帧缓冲 -> 加窗 -> CMSIS-DSP 实数 FFT -> 频带汇总
+ *
+ * VIB_Push 可以在 FIFO 中断回调里调用, 只做拷贝; 攒满一帧后切到另一块缓冲继续采集,
+ * 主循环里的 VIB_Process 对已满的那块做 FFT. 计算期间采集不停, 只有上一帧还没处理完
+ * 又攒满一帧时才丢帧 (计入 overruns).
+ *
+ * 每帧输出: 每轴 RMS、峰值频率/幅值、各频带 RMS (几十个字节, 可直接上传),
+ * 以及每轴的单边幅值谱 (可选).
+ *
+ * 依赖: 工程中需加入 CMSIS-DSP (arm_math.h, 定义 ARM_MATH_CM4 与 __FPU_PRESENT)
+ */
+
+// ================= 配置区域 =================
+
+/* FFT 长度上限 (2 的幂, 1024 ~ 4096), 决定静态缓冲大小:
+ * 帧缓冲 2 x 3 x N x 2B + 工作区 2 x N x 4B + 窗函数 N x 4B (+ 幅值谱 3 x N/2 x 4B) */
+#define VIB_FFT_LEN_MAX    2048
+
+/* 是否保留每轴的幅值谱 (VIB_GetSpectrum) */
+#define VIB_STORE_SPECTRUM 1
+
+/* 频带数量上限 */
+#define VIB_MAX_BANDS      8
+
+// ================= 数据结构 =================
+
+/* 分析哪组数据 */
+typedef enum {
+    VIB_SRC_ACCEL = 0,
+    VIB_SRC_GYRO
+} VIB_Source_t;
+
+/* 单帧分析结果 (单位与 scale 一致, 如 g) */
+typedef struct {
+    uint32_t seq;                        // 帧序号
+    float    rms[3];                     // 去直流后的时域 RMS
+    float    peak_hz[3];                 // 幅值最大的频点
+    float    peak_amp[3];                // 该频点的幅值 (峰值)
+    uint8_t  n_bands;
+    float    band_rms[3][VIB_MAX_BANDS]; // 各频带 RMS
+} VIB_Result_t;
+
+/* 运行统计 */
+typedef struct {
+    uint32_t samples;          // 累计输入采样数
+    uint32_t windows;          // 已处理帧数
+    uint32_t overruns;         // 处理不及时丢弃的帧数
+    uint32_t proc_cycles;      // 最近一帧处理耗时 (CPU 周期)
+    uint32_t proc_cycles_max;
+} VIB_Stats_t;
+
+// ================= 函数声明 =================
+
+/**
+ * @brief 初始化
+ * @param fft_len        帧长 (1024/2048/4096, <= VIB_FFT_LEN_MAX)
+ * @param hop            帧移 (1 ~ fft_len), fft_len/2 即 50% 重叠
+ * @param sample_rate_hz 采样率 (与 IMU ODR 一致)
+ * @param scale          物理量 / LSB, 一般传 icm.accel_scale
+ * @return 0 成功, -1 参数错误
+ */
+int8_t VIB_Init(uint16_t fft_len, uint16_t hop, float sample_rate_hz, float scale);
+void   VIB_SetSource(VIB_Source_t src);
+
+/* 频带: edges_hz 为 n_bands + 1 个递增的边界频率, 每个频带含下边界不含上边界 */
+int8_t VIB_SetBands(const float *edges_hz, uint8_t n_bands);
+
+/* 输入一批采样 (可在中断中调用) */
+void   VIB_Push(const ICM_RawData_t *samples, uint16_t n);
+
+/* 在主循环中调用: 有已满的帧则处理并返回 1, 否则返回 0 */
+int8_t VIB_Process(void);
+
+const VIB_Result_t *VIB_GetResult(void);
+#if VIB_STORE_SPECTRUM
+/* 单边幅值谱, 长度 fft_len / 2, 第 k 点频率 = k * fs / fft_len */
+const float *VIB_GetSpectrum(uint8_t axis);
+#endif
+
+void VIB_GetStats(VIB_Stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __VIBRATION_H__ */
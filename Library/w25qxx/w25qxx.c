@@ -5,15 +5,32 @@
 
 /**
  * @brief 片选拉低
+ * @return 0 成功, -1 占用总线超时 (未拉片选, 不能再调用 W25Q_CS_High)
  */
-static inline void W25Q_CS_Low(W25Q_Handle_t *dev) {
+static inline int8_t W25Q_CS_Low(W25Q_Handle_t *dev) {
+#if W25Q_USE_SPI_BUS
+    // 挂在总线上: 每条命令独占一次总线, 命令之间其他设备可以插入
+    if (dev->BusDev != NULL) {
+        if (SPIBus_Acquire(dev->BusDev, W25Q_TIMEOUT) != 0) return -1;
+        SPIBus_Select(dev->BusDev);
+        return 0;
+    }
+#endif
     HAL_GPIO_WritePin(dev->CS_Port, dev->CS_Pin, GPIO_PIN_RESET);
+    return 0;
 }
 
 /**
  * @brief 片选拉高
  */
 static inline void W25Q_CS_High(W25Q_Handle_t *dev) {
+#if W25Q_USE_SPI_BUS
+    if (dev->BusDev != NULL) {
+        SPIBus_Deselect(dev->BusDev);
+        SPIBus_Release(dev->BusDev);
+        return;
+    }
+#endif
     HAL_GPIO_WritePin(dev->CS_Port, dev->CS_Pin, GPIO_PIN_SET);
 }
 
@@ -57,21 +74,38 @@ static int8_t W25Q_SPI_TxRx(W25Q_Handle_t *dev, uint8_t *txData, uint8_t *rxData
 /**
  * @brief 写使能
  */
-static void W25Q_WriteEnable(W25Q_Handle_t *dev) {
+static int8_t W25Q_WriteEnable(W25Q_Handle_t *dev) {
     uint8_t cmd = W25Q_CMD_WRITE_ENABLE;
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
     W25Q_CS_High(dev);
+    return ret;
 }
 
 /**
  * @brief 等待芯片忙碌结束 (读取Status Register 1)
  */
-static void W25Q_WaitBusy(W25Q_Handle_t *dev) {
+static int8_t W25Q_WaitBusy(W25Q_Handle_t *dev) {
     uint8_t cmd = W25Q_CMD_READ_STATUS_R1;
     uint8_t status;
+
+#if W25Q_USE_SPI_BUS
+    // 挂在总线上时不能一直拉低片选轮询 (页编程/擦除期间会长时间霸占总线),
+    // 改为每次轮询一条独立的短命令, 两次轮询之间放行其他设备
+    if (dev->BusDev != NULL) {
+        uint8_t tx[2] = {W25Q_CMD_READ_STATUS_R1, 0xFF};
+        uint8_t rx[2];
+        do {
+            if (W25Q_CS_Low(dev) != 0) return -1;
+            int8_t ret = W25Q_SPI_TxRx(dev, tx, rx, 2);
+            W25Q_CS_High(dev);
+            if (ret != 0) return -1;
+        } while ((rx[1] & 0x01) == 0x01);
+        return 0;
+    }
+#endif
     
-    W25Q_CS_Low(dev);
+    if (W25Q_CS_Low(dev) != 0) return -1;
     W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
     
     do {
@@ -79,28 +113,25 @@ static void W25Q_WaitBusy(W25Q_Handle_t *dev) {
     } while ((status & 0x01) == 0x01); // 检查BUSY位 (Bit 0)
     
     W25Q_CS_High(dev);
+    return 0;
 }
 
-// ================= 外部接口实现 =================
-
 /**
- * @brief 初始化W25Q驱动
+ * @brief 初始化公共部分 (BusDev 已由调用者设置)
  */
-int8_t W25Q_Init(W25Q_Handle_t *dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef *cs_port, uint16_t cs_pin) {
-    if (dev == NULL || hspi == NULL) return -1;
-
+static int8_t W25Q_Setup(W25Q_Handle_t *dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef *cs_port, uint16_t cs_pin) {
     dev->hspi = hspi;
     dev->CS_Port = cs_port;
     dev->CS_Pin = cs_pin;
 
-    W25Q_CS_High(dev); // 默认不选中
+    HAL_GPIO_WritePin(dev->CS_Port, dev->CS_Pin, GPIO_PIN_SET); // 默认不选中 (此时未占用总线)
     HAL_Delay(100);    // 上电等待
 
     // 读取ID
     uint8_t cmd = W25Q_CMD_JEDEC_ID;
     uint8_t id_data[3];
     
-    W25Q_CS_Low(dev);
+    if (W25Q_CS_Low(dev) != 0) return -1;
     W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
     W25Q_SPI_TxRx(dev, NULL, id_data, 3);
     W25Q_CS_High(dev);
@@ -125,27 +156,54 @@ int8_t W25Q_Init(W25Q_Handle_t *dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef *cs_p
     return 0;
 }
 
+// ================= 外部接口实现 =================
+
+/**
+ * @brief 初始化W25Q驱动
+ */
+int8_t W25Q_Init(W25Q_Handle_t *dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef *cs_port, uint16_t cs_pin) {
+    if (dev == NULL || hspi == NULL) return -1;
+
+#if W25Q_USE_SPI_BUS
+    dev->BusDev = NULL; // 独占 SPI (句柄可能未清零)
+#endif
+    return W25Q_Setup(dev, hspi, cs_port, cs_pin);
+}
+
+#if W25Q_USE_SPI_BUS
+/**
+ * @brief 通过总线仲裁器初始化
+ */
+int8_t W25Q_InitOnBus(W25Q_Handle_t *dev, SPIBus_Device_t *bus_dev) {
+    if (dev == NULL || bus_dev == NULL || bus_dev->bus->hspi == NULL) return -1;
+
+    dev->BusDev = bus_dev;
+    return W25Q_Setup(dev, bus_dev->bus->hspi, bus_dev->cs_port, bus_dev->cs_pin);
+}
+#endif
+
 /**
  * @brief 读取数据
  */
-void W25Q_Read(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
+int8_t W25Q_Read(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
     uint8_t cmd[4];
     cmd[0] = W25Q_CMD_READ_DATA;
     cmd[1] = (uint8_t)((addr >> 16) & 0xFF);
     cmd[2] = (uint8_t)((addr >> 8) & 0xFF);
     cmd[3] = (uint8_t)(addr & 0xFF);
 
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, cmd, NULL, 4);   // 发送指令+地址
-    W25Q_SPI_TxRx(dev, NULL, pData, len); // 读取数据
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, cmd, NULL, 4);        // 发送指令+地址
+    if (ret == 0) ret = W25Q_SPI_TxRx(dev, NULL, pData, len); // 读取数据
     W25Q_CS_High(dev);
+    return ret;
 }
 
 /**
  * @brief 内部函数：写入一页 (不进行边界检查)
  */
-static void W25Q_WritePage(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
-    W25Q_WriteEnable(dev);
+static int8_t W25Q_WritePage(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
+    if (W25Q_WriteEnable(dev) != 0) return -1;
 
     uint8_t cmd[4];
     cmd[0] = W25Q_CMD_PAGE_PROGRAM;
@@ -153,25 +211,26 @@ static void W25Q_WritePage(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, ui
     cmd[2] = (uint8_t)((addr >> 8) & 0xFF);
     cmd[3] = (uint8_t)(addr & 0xFF);
 
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, cmd, NULL, 4);
-    W25Q_SPI_TxRx(dev, pData, NULL, len);
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, cmd, NULL, 4);
+    if (ret == 0) ret = W25Q_SPI_TxRx(dev, pData, NULL, len);
     W25Q_CS_High(dev);
+    if (ret != 0) return -1;
 
-    W25Q_WaitBusy(dev);
+    return W25Q_WaitBusy(dev);
 }
 
 /**
  * @brief 写入任意长度数据 (自动处理页对齐和翻页)
  */
-void W25Q_Write(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
+int8_t W25Q_Write(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len) {
     uint32_t pageremain;
     pageremain = 256 - addr % 256; // 单页剩余空间
 
     if (len <= pageremain) pageremain = len; // 如果数据量小于剩余空间
 
     while (1) {
-        W25Q_WritePage(dev, addr, pData, pageremain);
+        if (W25Q_WritePage(dev, addr, pData, pageremain) != 0) return -1;
         
         if (len == pageremain) break; // 写入完成
 
@@ -183,17 +242,17 @@ void W25Q_Write(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len)
         if (len > 256) pageremain = 256;
         else pageremain = len;
     }
+    return 0;
 }
 
 /**
  * @brief 扇区擦除 (4KB)
  */
-void W25Q_EraseSector(W25Q_Handle_t *dev, uint32_t sector_addr) {
+int8_t W25Q_EraseSector(W25Q_Handle_t *dev, uint32_t sector_addr) {
     // 确保地址对齐到扇区首地址 (虽然W25Q通常忽略低位，但最好处理一下)
     // sector_addr *= 4096; // 如果传入的是扇区号而非地址，取消此注释
 
-    W25Q_WriteEnable(dev);
-    W25Q_WaitBusy(dev);
+    if (W25Q_WriteEnable(dev) != 0 || W25Q_WaitBusy(dev) != 0) return -1;
 
     uint8_t cmd[4];
     cmd[0] = W25Q_CMD_SECTOR_ERASE;
@@ -201,19 +260,19 @@ void W25Q_EraseSector(W25Q_Handle_t *dev, uint32_t sector_addr) {
     cmd[2] = (uint8_t)((sector_addr >> 8) & 0xFF);
     cmd[3] = (uint8_t)(sector_addr & 0xFF);
 
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, cmd, NULL, 4);
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, cmd, NULL, 4);
     W25Q_CS_High(dev);
+    if (ret != 0) return -1;
 
-    W25Q_WaitBusy(dev);
+    return W25Q_WaitBusy(dev);
 }
 
 /**
  * @brief 块擦除 (64KB)
  */
-void W25Q_EraseBlock(W25Q_Handle_t *dev, uint32_t block_addr) {
-    W25Q_WriteEnable(dev);
-    W25Q_WaitBusy(dev);
+int8_t W25Q_EraseBlock(W25Q_Handle_t *dev, uint32_t block_addr) {
+    if (W25Q_WriteEnable(dev) != 0 || W25Q_WaitBusy(dev) != 0) return -1;
 
     uint8_t cmd[4];
     cmd[0] = W25Q_CMD_BLOCK_ERASE_64K;
@@ -221,25 +280,26 @@ void W25Q_EraseBlock(W25Q_Handle_t *dev, uint32_t block_addr) {
     cmd[2] = (uint8_t)((block_addr >> 8) & 0xFF);
     cmd[3] = (uint8_t)(block_addr & 0xFF);
 
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, cmd, NULL, 4);
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, cmd, NULL, 4);
     W25Q_CS_High(dev);
+    if (ret != 0) return -1;
 
-    W25Q_WaitBusy(dev);
+    return W25Q_WaitBusy(dev);
 }
 
 /**
  * @brief 整片擦除 (耗时很长!)
  */
-void W25Q_EraseChip(W25Q_Handle_t *dev) {
-    W25Q_WriteEnable(dev);
-    W25Q_WaitBusy(dev);
+int8_t W25Q_EraseChip(W25Q_Handle_t *dev) {
+    if (W25Q_WriteEnable(dev) != 0 || W25Q_WaitBusy(dev) != 0) return -1;
 
     uint8_t cmd = W25Q_CMD_CHIP_ERASE;
 
-    W25Q_CS_Low(dev);
-    W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
+    if (W25Q_CS_Low(dev) != 0) return -1;
+    int8_t ret = W25Q_SPI_TxRx(dev, &cmd, NULL, 1);
     W25Q_CS_High(dev);
+    if (ret != 0) return -1;
 
-    W25Q_WaitBusy(dev);
+    return W25Q_WaitBusy(dev);
 }
\ No newline at end of file
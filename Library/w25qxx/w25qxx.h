@@ -18,6 +18,13 @@ extern "C" {
 /* 默认超时时间 */
 #define W25Q_TIMEOUT     1000
 
+/* 是否挂在 SPI 总线仲裁器上 (与其他 SPI 设备共用总线): 1=是, 0=独占 SPI */
+#define W25Q_USE_SPI_BUS 0
+
+#if W25Q_USE_SPI_BUS
+#include "spi_bus.h"
+#endif
+
 // ================= 指令定义 =================
 #define W25Q_CMD_WRITE_ENABLE       0x06
 #define W25Q_CMD_WRITE_DISABLE      0x04
@@ -54,6 +61,9 @@ typedef struct {
     uint32_t          PageCount;   // 页数量
     uint32_t          BlockCount;  // 块数量
     uint32_t          Capacity;    // 总容量(Bytes)
+#if W25Q_USE_SPI_BUS
+    SPIBus_Device_t   *BusDev;     // 总线设备, NULL 表示独占 SPI
+#endif
 } W25Q_Handle_t;
 
 // ================= 函数声明 =================
@@ -61,14 +71,19 @@ typedef struct {
 /* 初始化 */
 int8_t W25Q_Init(W25Q_Handle_t *dev, SPI_HandleTypeDef *hspi, GPIO_TypeDef *cs_port, uint16_t cs_pin);
 
-/* 基础操作 */
-void W25Q_Read(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len);
-void W25Q_Write(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len); // 智能写，自动处理分页
+#if W25Q_USE_SPI_BUS
+/* 通过总线仲裁器初始化 (SPI 句柄与片选取自 bus_dev) */
+int8_t W25Q_InitOnBus(W25Q_Handle_t *dev, SPIBus_Device_t *bus_dev);
+#endif
+
+/* 基础操作 (返回 0 成功, -1 SPI 失败或占用总线超时) */
+int8_t W25Q_Read(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len);
+int8_t W25Q_Write(W25Q_Handle_t *dev, uint32_t addr, uint8_t *pData, uint32_t len); // 智能写，自动处理分页
 
 /* 擦除操作 */
-void W25Q_EraseSector(W25Q_Handle_t *dev, uint32_t sector_addr); // 擦除4KB
-void W25Q_EraseBlock(W25Q_Handle_t *dev, uint32_t block_addr);   // 擦除64KB
-void W25Q_EraseChip(W25Q_Handle_t *dev);
+int8_t W25Q_EraseSector(W25Q_Handle_t *dev, uint32_t sector_addr); // 擦除4KB
+int8_t W25Q_EraseBlock(W25Q_Handle_t *dev, uint32_t block_addr);   // 擦除64KB
+int8_t W25Q_EraseChip(W25Q_Handle_t *dev);
 
 /* 休眠与唤醒 (可选) */
 void W25Q_PowerDown(W25Q_Handle_t *dev);